@@ -0,0 +1,255 @@
+#include "utils/InputReport.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Doncon;
+
+namespace {
+
+struct Mode {
+    usb_mode_t mode;
+    const char *name;
+};
+
+const std::array<Mode, 13> modes = {{
+    {USB_MODE_SWITCH_TATACON, "switch_tatacon"},
+    {USB_MODE_SWITCH_HORIPAD, "switch_horipad"},
+    {USB_MODE_DUALSHOCK3, "dualshock3"},
+    {USB_MODE_PS4_TATACON, "ps4_tatacon"},
+    {USB_MODE_DUALSHOCK4, "dualshock4"},
+    {USB_MODE_KEYBOARD_P1, "keyboard_p1"},
+    {USB_MODE_KEYBOARD_P2, "keyboard_p2"},
+    {USB_MODE_XBOX360, "xbox360"},
+    {USB_MODE_XBOX360_ANALOG_P1, "xbox360_analog_p1"},
+    {USB_MODE_XBOX360_ANALOG_P2, "xbox360_analog_p2"},
+    {USB_MODE_MIDI, "midi"},
+    {USB_MODE_DEBUG, "debug"},
+    {USB_MODE_CAPTURE, "capture"},
+}};
+
+// Every mode is run with the default mapping and with sides and face buttons swapped, the latter is recorded with
+// a "_remap" suffix.
+struct Remap {
+    const char *suffix;
+    Utils::InputRemap::Mapping mapping;
+};
+
+const std::array<Remap, 2> remaps = {{
+    {"", Utils::InputRemap::identity()},
+    {"_remap",
+     [] {
+         using Input = Utils::InputState::Input;
+
+         auto mapping = Utils::InputRemap::identity();
+         const auto swap = [&mapping](const Input a, const Input b) {
+             std::swap(mapping[static_cast<size_t>(a)], mapping[static_cast<size_t>(b)]);
+         };
+         swap(Input::DonLeft, Input::DonRight);
+         swap(Input::KaLeft, Input::KaRight);
+         swap(Input::North, Input::West);
+         swap(Input::East, Input::South);
+         return mapping;
+     }()},
+}};
+
+const size_t corpus_size = 4096;
+const uint32_t corpus_seed = 0x2040D0C0;
+
+class XorShift32 {
+  private:
+    uint32_t m_state;
+
+  public:
+    explicit XorShift32(uint32_t seed) : m_state(seed) {}
+
+    uint32_t next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+};
+
+// Deterministic mix of idle states, single hits, chords and random button combinations.
+std::vector<Utils::InputState> generateCorpus() {
+    std::vector<Utils::InputState> corpus(corpus_size);
+    XorShift32 rng(corpus_seed);
+
+    using Input = Utils::InputState::Input;
+
+    auto random_pad = [&](Utils::InputState::Drum &drum, const Input pad, const bool allow_trigger) {
+        const auto bits = rng.next();
+
+        if (allow_trigger && (bits & 0x1)) {
+            drum.triggered |= Utils::InputState::bit(pad);
+        }
+        drum.analog[pad] = static_cast<uint16_t>((bits >> 4) & 0x0FFF);
+        drum.raw[pad] = static_cast<uint16_t>((bits >> 16) & 0x0FFF);
+    };
+
+    for (size_t idx = 0; idx < corpus.size(); ++idx) {
+        auto &state = corpus[idx];
+
+        // Every fourth state is idle to cover the 'nothing pressed' paths.
+        if (idx % 4 == 0) {
+            continue;
+        }
+
+        const bool drum_active = (idx % 4) != 3;
+        random_pad(state.drum, Input::DonLeft, drum_active);
+        random_pad(state.drum, Input::KaLeft, drum_active);
+        random_pad(state.drum, Input::DonRight, drum_active);
+        random_pad(state.drum, Input::KaRight, drum_active);
+        state.drum.current_roll = static_cast<uint16_t>(rng.next() & 0x3FF);
+        state.drum.previous_roll = static_cast<uint16_t>(rng.next() & 0x3FF);
+
+        // Buttons in the order Up, Down, Left, Right, North, East, South, West, L, R, Start, Select, Home, Share
+        const auto buttons = rng.next() & 0x3FFF;
+        state.controller.buttons = buttons << static_cast<uint8_t>(Input::Up);
+    }
+
+    return corpus;
+}
+
+// FNV-1a over size and content of every report produced for the corpus.
+uint64_t digestMode(const std::vector<Utils::InputState> &corpus, const usb_mode_t mode,
+                    const Utils::InputRemap::Mapping &mapping) {
+    Utils::InputReport input_report;
+    input_report.setInputRemap(mapping);
+    uint64_t hash = 0xCBF29CE484222325;
+
+    auto feed = [&](const uint8_t byte) {
+        hash ^= byte;
+        hash *= 0x100000001B3;
+    };
+
+    for (const auto &state : corpus) {
+        const auto report = input_report.getReport(state, mode);
+
+        feed(report.size & 0xFF);
+        feed(report.size >> 8);
+        for (uint16_t i = 0; i < report.size; ++i) {
+            feed(report.data[i]);
+        }
+    }
+
+    return hash;
+}
+
+double benchmarkMode(const std::vector<Utils::InputState> &corpus, const usb_mode_t mode,
+                     const Utils::InputRemap::Mapping &mapping, const int iterations) {
+    Utils::InputReport input_report;
+    input_report.setInputRemap(mapping);
+    volatile uint32_t sink = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (const auto &state : corpus) {
+            const auto report = input_report.getReport(state, mode);
+            sink = sink + report.size + (report.size > 0 ? report.data[report.size - 1] : 0);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (static_cast<double>(iterations) * static_cast<double>(corpus.size()));
+}
+
+std::map<std::string, uint64_t> readGolden(const char *path) {
+    std::map<std::string, uint64_t> golden;
+    std::ifstream file(path);
+    std::string name;
+    std::string digest;
+
+    while (file >> name >> digest) {
+        golden[name] = std::strtoull(digest.c_str(), nullptr, 16);
+    }
+
+    return golden;
+}
+
+void usage(const char *argv0) {
+    std::fprintf(stderr, "Usage: %s [--iterations N] [--golden FILE] [--record FILE]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int iterations = 200;
+    const char *golden_path = nullptr;
+    const char *record_path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    const auto corpus = generateCorpus();
+    const auto golden = golden_path ? readGolden(golden_path) : std::map<std::string, uint64_t>{};
+
+    std::FILE *record = nullptr;
+    if (record_path) {
+        record = std::fopen(record_path, "w");
+        if (!record) {
+            std::fprintf(stderr, "Cannot open '%s' for writing\n", record_path);
+            return 2;
+        }
+    }
+
+    int failures = 0;
+
+    std::printf("%-24s %12s  %-16s %s\n", "mode", "ns/call", "digest", "golden");
+    for (const auto &remap : remaps) {
+        for (const auto &mode : modes) {
+            const std::string name = std::string(mode.name) + remap.suffix;
+            const auto digest = digestMode(corpus, mode.mode, remap.mapping);
+            const auto ns_per_call =
+                iterations > 0 ? benchmarkMode(corpus, mode.mode, remap.mapping, iterations) : 0.0;
+
+            const char *result = "-";
+            if (golden_path) {
+                const auto expected = golden.find(name);
+                if (expected == golden.end()) {
+                    result = "MISSING";
+                    failures++;
+                } else if (expected->second != digest) {
+                    result = "MISMATCH";
+                    failures++;
+                } else {
+                    result = "ok";
+                }
+            }
+
+            std::printf("%-24s %12.2f  %016llx %s\n", name.c_str(), ns_per_call,
+                        static_cast<unsigned long long>(digest), result);
+
+            if (record) {
+                std::fprintf(record, "%s %016llx\n", name.c_str(), static_cast<unsigned long long>(digest));
+            }
+        }
+    }
+
+    if (record) {
+        std::fclose(record);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
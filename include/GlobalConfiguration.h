@@ -5,10 +5,13 @@
 #include "peripherals/Display.h"
 #include "peripherals/Drum.h"
 #include "peripherals/StatusLed.h"
+#include "utils/InputRemap.h"
 
 #include "hardware/i2c.h"
 #include "hardware/spi.h"
 
+#include <array>
+
 namespace Doncon::Config {
 
 struct I2c {
@@ -22,6 +25,17 @@ namespace Default {
 
 const usb_mode_t usb_mode = USB_MODE_SWITCH_TATACON;
 
+// Digital input remapping, applied in all controller emulation modes. Each entry
+// selects the input the physical input at that position is reported as, e.g.
+// swapping North and West:
+//
+// const Utils::InputRemap::Mapping input_remap = {
+//     Utils::InputState::Input::DonLeft, Utils::InputState::Input::KaLeft, ...
+//     Utils::InputState::Input::West, Utils::InputState::Input::East,
+//     Utils::InputState::Input::South, Utils::InputState::Input::North, ...
+// };
+const Utils::InputRemap::Mapping input_remap = Utils::InputRemap::identity();
+
 const I2c i2c_config = {
     .sda_pin = 14,
     .scl_pin = 15,
@@ -29,7 +43,7 @@ const I2c i2c_config = {
     .speed_hz = 1000000,
 };
 
-const Peripherals::Drum::Config drum_config = {
+const Peripherals::DrumBase::Config drum_config = {
     .trigger_thresholds =
         {
             .don_left = 10,
@@ -38,7 +52,7 @@ const Peripherals::Drum::Config drum_config = {
             .ka_right = 5,
         },
 
-    .double_trigger_mode = Peripherals::Drum::Config::DoubleTriggerMode::Off,
+    .double_trigger_mode = Peripherals::DrumBase::Config::DoubleTriggerMode::Off,
     .double_trigger_thresholds =
         {
             .don_left = 2000,
@@ -57,26 +71,31 @@ const Peripherals::Drum::Config drum_config = {
             .don_right = 0,
             .ka_right = 1,
         },
+};
 
-    // ADC Config, either InternalAdc or ExternalAdc
-    // .adc_config =
-    //     Peripherals::Drum::Config::InternalAdc{
-    //         .sample_count = 16,
-    //     },
-
-    .adc_config =
-        Peripherals::Drum::Config::ExternalAdc{
-            .spi_block = spi1,
-            .spi_speed_hz = 2000000,
-            .spi_mosi_pin = 11,
-            .spi_miso_pin = 12,
-            .spi_sclk_pin = 10,
-            .spi_scsn_pin = 13,
-            .spi_level_shifter_enable_pin = 9,
-        },
+// Names of the settings profiles. Each profile has its own trigger thresholds, hold time and double trigger
+// settings, all starting out with the values from drum_config above. Switch between them in the menu or by
+// holding Select and pressing L or R.
+constexpr std::array<const char *, 4> profile_names = {"Default", "Switch", "PS4", "PC"};
+
+// ADC backend, either InternalAdc or ExternalAdc
+// using DrumAdc = Peripherals::InternalAdc;
+// const DrumAdc::Config drum_adc_config = {
+//     .sample_count = 16,
+// };
+
+using DrumAdc = Peripherals::ExternalAdc;
+const DrumAdc::Config drum_adc_config = {
+    .spi_block = spi1,
+    .spi_speed_hz = 2000000,
+    .spi_mosi_pin = 11,
+    .spi_miso_pin = 12,
+    .spi_sclk_pin = 10,
+    .spi_scsn_pin = 13,
+    .spi_level_shifter_enable_pin = 9,
 };
 
-const Peripherals::Controller::Config controller_config = {
+const Peripherals::ControllerBase::Config controller_config = {
     .pins =
         {
             .dpad =
@@ -104,16 +123,29 @@ const Peripherals::Controller::Config controller_config = {
         },
 
     .debounce_delay_ms = 25,
+};
 
-    // GPIO Config, either InternalGpio or ExternalGpio
-    // .gpio_config = Peripherals::Controller::Config::InternalGpio{},
-    .gpio_config =
-        Peripherals::Controller::Config::ExternalGpio{
-            .i2c =
-                {
-                    .block = i2c_config.block,
-                    .address = 0x20,
-                },
+// GPIO backend, either InternalGpio, PioGpio or ExternalGpio
+// using ControllerGpio = Peripherals::InternalGpio;
+// const ControllerGpio::Config controller_gpio_config = {};
+
+// using ControllerGpio = Peripherals::PioGpio;
+// const ControllerGpio::Config controller_gpio_config = {
+//     .pio = pio1,
+// };
+
+using ControllerGpio = Peripherals::ExternalGpio;
+const ControllerGpio::Config controller_gpio_config = {
+    .i2c =
+        {
+            .block = i2c_config.block,
+            .address = 0x20,
+        },
+    .interrupt =
+        {
+            .enabled = false, // Requires INTA or INTB of the MCP23017 to be connected to the pin below
+            .pin = 8,
+            .safety_poll_interval_ms = 100,
         },
 };
 
@@ -123,11 +155,28 @@ const Peripherals::StatusLed::Config led_config = {
     .ka_left_color = {.r = 0, .g = 0, .b = 255},
     .don_right_color = {.r = 255, .g = 255, .b = 0},
     .ka_right_color = {.r = 0, .g = 255, .b = 255},
+    .roll_color = {.r = 255, .g = 0, .b = 255},
 
     .led_enable_pin = 25,
     .led_pin = 16,
+    .led_count = 1,
     .is_rgbw = false,
 
+    // LEDs lit by each pad, e.g. for a strip of 20 LEDs along the drum:
+    // .zones = {.don_left = {.first = 5, .count = 5}, .ka_left = {.first = 0, .count = 5},
+    //           .don_right = {.first = 10, .count = 5}, .ka_right = {.first = 15, .count = 5}},
+    .zones =
+        {
+            .don_left = {.first = 0, .count = 1},
+            .ka_left = {.first = 0, .count = 1},
+            .don_right = {.first = 0, .count = 1},
+            .ka_right = {.first = 0, .count = 1},
+        },
+
+    .frame_rate = 100,
+    .trail_ms = 150,
+    .roll_full_speed = 15,
+
     .brightness = 255,
     .enable_player_color = true,
 };
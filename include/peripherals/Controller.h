@@ -2,18 +2,113 @@
 #define PERIPHERALS_CONTROLLER_H_
 
 #include "utils/InputState.h"
+#include "utils/TimingStats.h"
 
+#include "hardware/gpio.h"
 #include "hardware/i2c.h"
+#include "hardware/pio.h"
 #include <mcp23017/Mcp23017.h>
+#include <pio_buttons/buttons.h>
 
+#include <array>
 #include <cstdint>
-#include <map>
-#include <memory>
-#include <variant>
 
 namespace Doncon::Peripherals {
 
-class Controller {
+// GPIO backends provide uses_i2c, whether reads need the shared I2C bus, and debounces, whether read() already
+// returns a debounced state. Other backends are debounced by ControllerBase.
+
+// Bus statistics of a GPIO backend, to compare polling with interrupt driven reads.
+struct GpioStats {
+    Utils::TimingStats latency; // Time from an input change until it was read
+    uint32_t reads;
+    uint32_t bus_time_us;
+};
+
+// Buttons connected directly to RP2040 GPIO pins.
+class InternalGpio {
+  public:
+    struct Config {};
+
+    static constexpr bool uses_i2c = false;
+    static constexpr bool debounces = false;
+
+    InternalGpio(const Config &config, uint32_t pin_mask, uint8_t debounce_delay_ms);
+
+    [[nodiscard]] bool isReadPending() { return true; }
+    uint32_t read() { return ~gpio_get_all(); }
+
+    GpioStats takeStats() { return {}; }
+};
+
+// Buttons connected directly to RP2040 GPIO pins, sampled by a PIO state machine at a fixed rate. Contact bounce
+// is filtered per pin with debounce_delay_ms as soon as the state machine reports a change, so edges are timed
+// independent of the core 1 workload. Core 0 still only sees the state read by the last core 1 loop. The button
+// pins need to be contiguous, other pins are not sampled at all.
+class PioGpio {
+  public:
+    struct Config {
+        PIO pio;
+    };
+
+    static constexpr bool uses_i2c = false;
+    static constexpr bool debounces = true;
+
+  private:
+    uint m_pin_base;
+
+  public:
+    PioGpio(const Config &config, uint32_t pin_mask, uint8_t debounce_delay_ms);
+
+    [[nodiscard]] bool isReadPending() { return true; }
+    uint32_t read() { return ~(buttons_get_state() << m_pin_base); }
+
+    // reads is the number of changes reported by the state machine, it stays at 0 while no button is touched.
+    GpioStats takeStats() { return {.latency = {}, .reads = buttons_take_event_count(), .bus_time_us = 0}; }
+};
+
+// Buttons connected to an MCP23017 I2C GPIO expander.
+class ExternalGpio {
+  public:
+    struct Config {
+        struct {
+            i2c_inst_t *block;
+            uint8_t address;
+        } i2c;
+
+        // Read the expander only after its INT pin signals a change instead of on every update. A read
+        // still happens every safety_poll_interval_ms in case an interrupt got lost.
+        struct {
+            bool enabled;
+            uint8_t pin;
+            uint16_t safety_poll_interval_ms;
+        } interrupt;
+    };
+
+  private:
+    Config m_config;
+    Mcp23017 m_mcp23017;
+
+    uint32_t m_state{0};
+    bool m_read_pending{true};
+    uint32_t m_last_read_us{0};
+    GpioStats m_stats{};
+
+  public:
+    static constexpr bool uses_i2c = true;
+    static constexpr bool debounces = false;
+
+    ExternalGpio(const Config &config, uint32_t pin_mask, uint8_t debounce_delay_ms);
+
+    // Whether the next read() needs the I2C bus, otherwise it returns the last state.
+    [[nodiscard]] bool isReadPending();
+    uint32_t read();
+
+    GpioStats takeStats();
+};
+
+// GPIO independent part of the controller logic, see Controller for the actual peripheral.
+class ControllerBase {
   public:
     struct Config {
         struct Pins {
@@ -40,19 +135,8 @@ class Controller {
             } buttons;
         };
 
-        struct InternalGpio {};
-
-        struct ExternalGpio {
-            struct {
-                i2c_inst_t *block;
-                uint8_t address;
-            } i2c;
-        };
-
         Pins pins;
         uint8_t debounce_delay_ms;
-
-        std::variant<InternalGpio, ExternalGpio> gpio_config;
     };
 
   private:
@@ -72,64 +156,59 @@ class Controller {
         HOME,
         SHARE,
     };
+    static constexpr size_t BUTTON_COUNT = 14;
 
-    class Button {
-      private:
-        uint8_t m_gpio_pin;
-        uint32_t m_gpio_mask;
-
-        uint32_t m_last_change{0};
-        bool m_active{false};
+    // GPIO bit of a button and the InputState bit it is reported as.
+    struct Mapping {
+        uint32_t gpio_mask;
+        uint32_t input_mask;
+    };
 
-      public:
-        Button(uint8_t pin);
+    // Debouncing runs on the whole GPIO word at once. A change is applied immediately, afterwards the
+    // input is locked for debounce_delay_ms. The remaining lock time of all inputs is kept in a vertical
+    // counter, plane n holds bit n of each input's counter.
+    static constexpr size_t DEBOUNCE_COUNTER_BITS = 8 * sizeof(Config::debounce_delay_ms);
 
-        [[nodiscard]] uint8_t getGpioPin() const { return m_gpio_pin; };
-        [[nodiscard]] uint32_t getGpioMask() const { return m_gpio_mask; };
+    Config m_config;
+    std::array<Mapping, BUTTON_COUNT> m_mappings;
+    uint32_t m_pin_mask;
 
-        [[nodiscard]] bool getState() const { return m_active; };
-        void setState(bool state, uint8_t debounce_delay);
-    };
+    uint32_t m_debounced{0};
+    std::array<uint32_t, DEBOUNCE_COUNTER_BITS> m_lock_counter{};
+    uint32_t m_last_scan{0};
 
-    struct SocdState {
-        Id lastVertical;
-        Id lastHorizontal;
-    };
+    // InputState bits of the last direction pressed alone on each axis, it loses if both get pressed.
+    uint32_t m_socd_last;
 
-    // NOLINTNEXTLINE(cppcoreguidelines-special-member-functions): Class has no members
-    class GpioInterface {
-      public:
-        virtual ~GpioInterface() = default;
-        virtual uint32_t read() = 0;
-    };
+    static Utils::InputState::Input toInput(Id id);
 
-    class InternalGpio : public GpioInterface {
-      public:
-        InternalGpio(const std::map<Id, Button> &buttons);
-        uint32_t read() final;
-    };
+    uint32_t debounce(uint32_t gpio_state);
+    void socdClean(Utils::InputState &input_state);
 
-    class ExternalGpio : public GpioInterface {
-      private:
-        Mcp23017 m_mcp23017;
+  protected:
+    ControllerBase(const Config &config);
 
-      public:
-        ExternalGpio(const Config::ExternalGpio &config);
-        uint32_t read() final;
-    };
+    [[nodiscard]] uint32_t getPinMask() const;
+    void updateInputState(Utils::InputState &input_state, uint32_t gpio_state, bool is_debounced);
+};
 
-    Config m_config;
-    SocdState m_socd_state{.lastVertical = Id::DOWN, .lastHorizontal = Id::RIGHT};
-    std::map<Id, Button> m_buttons;
+// Controller peripheral reading from GPIO backend TGpio, which is InternalGpio, PioGpio or ExternalGpio. The
+// backend is fixed at compile time, so reads can be inlined.
+template <typename TGpio> class Controller : public ControllerBase {
+  private:
+    TGpio m_gpio;
 
-    std::unique_ptr<GpioInterface> m_gpio;
+  public:
+    Controller(const Config &config, const typename TGpio::Config &gpio_config)
+        : ControllerBase(config), m_gpio(gpio_config, getPinMask(), config.debounce_delay_ms) {}
 
-    void socdClean(Utils::InputState &input_state);
+    [[nodiscard]] bool isReadPending() { return m_gpio.isReadPending(); }
 
-  public:
-    Controller(const Config &config);
+    void updateInputState(Utils::InputState &input_state) {
+        ControllerBase::updateInputState(input_state, m_gpio.read(), TGpio::debounces);
+    }
 
-    void updateInputState(Utils::InputState &input_state);
+    GpioStats takeGpioStats() { return m_gpio.takeStats(); }
 };
 
 } // namespace Doncon::Peripherals
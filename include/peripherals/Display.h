@@ -1,15 +1,18 @@
 #ifndef PERIPHERALS_DISPLAY_H_
 #define PERIPHERALS_DISPLAY_H_
 
+#include "peripherals/Drum.h"
 #include "usb/device_driver.h"
+#include "utils/DrumScope.h"
 #include "utils/InputState.h"
 #include "utils/Menu.h"
+#include "utils/TimingStats.h"
 
 #include "hardware/i2c.h"
 #include <ssd1306/ssd1306.h>
 
+#include <array>
 #include <cstdint>
-#include <memory>
 
 namespace Doncon::Peripherals {
 
@@ -20,26 +23,88 @@ class Display {
         uint8_t i2c_address;
     };
 
+    // Content of the idle screen, roll counter, scrolling signal scope or timeline of hits.
+    enum class IdleView : uint8_t {
+        Rolls,
+        Scope,
+        Timeline,
+    };
+
   private:
     enum class State : uint8_t {
         Idle,
         Menu,
     };
 
+    static constexpr uint8_t WIDTH = 128;
+    static constexpr uint8_t HEIGHT = 64;
+
+    // Scope samples per column, i.e. the scope shows the last 256ms and the timeline the last 2.56s.
+    static constexpr uint8_t SCOPE_DECIMATION = 2;
+    static constexpr uint8_t TIMELINE_DECIMATION = 20;
+
+    // Layout of the scope and timeline views, one lane per pad
+    static constexpr uint32_t LANE_TOP = 12;
+    static constexpr uint32_t LANE_HEIGHT = 10;
+
+    // Layout of the signal meter page
+    static constexpr uint32_t METER_TOP = 14;
+    static constexpr uint32_t METER_ROW_HEIGHT = 13;
+    static constexpr uint32_t METER_BAR_X = 40;
+    static constexpr uint32_t METER_BAR_WIDTH = 87;
+    static constexpr uint32_t METER_BAR_HEIGHT = 7;
+
+    // Peak values and hits of each column, oldest column first starting at next.
+    struct ScopeHistory {
+        std::array<Utils::DrumScope::Sample, WIDTH> columns{};
+        size_t next{0};
+        Utils::DrumScope::Sample pending{};
+        uint8_t pending_count{0};
+
+        // Returns whether the visible history changed.
+        bool add(const Utils::DrumScope::Sample &sample, uint8_t decimation);
+        [[nodiscard]] const Utils::DrumScope::Sample &column(size_t x) const { return columns[(next + x) % WIDTH]; }
+    };
+
     Config m_config;
     State m_state{State::Idle};
+    IdleView m_idle_view{IdleView::Rolls};
 
     Utils::InputState m_input_state;
     usb_mode_t m_usb_mode{USB_MODE_DEBUG};
     uint8_t m_player_id{0};
+    uint8_t m_profile{0};
+    DrumBase::Config::Thresholds m_trigger_thresholds{};
+
+    // Highest raw value of each pad in the scope samples since the last frame, and the peak held for a while on
+    // the signal meter.
+    Utils::InputState::PadArray<uint16_t> m_meter_levels{};
+    Utils::InputState::PadArray<uint16_t> m_meter_peaks{};
+    Utils::InputState::PadArray<uint32_t> m_meter_peak_times{};
+
+    ScopeHistory m_scope;
+    ScopeHistory m_timeline;
 
     Utils::Menu::State m_menu_state{};
 
     ssd1306_t m_display{};
-    uint32_t m_next_frame_time{0};
+    uint32_t m_last_frame_time{0};
+    bool m_dirty{true};
+    Utils::TimingStats m_render_time;
+
+    // Pre-rendered static parts of the current screen, see drawBackground().
+    std::array<uint8_t, WIDTH * HEIGHT / 8> m_background{};
+    bool m_background_valid{false};
+    State m_background_state{State::Idle};
+    Utils::Menu::Page m_background_page{Utils::Menu::Page::Main};
 
+    void drawBackground();
     void drawIdleScreen();
+    void drawRolls();
+    void drawScope();
+    void drawTimeline();
     void drawMenuScreen();
+    void drawSignalMeter();
 
   public:
     Display(const Config &config);
@@ -47,13 +112,27 @@ class Display {
     void setInputState(const Utils::InputState &state);
     void setUsbMode(usb_mode_t mode);
     void setPlayerId(uint8_t player_id);
+    void setProfile(uint8_t profile);
+    void setTriggerThresholds(const DrumBase::Config::Thresholds &thresholds);
 
     void setMenuState(const Utils::Menu::State &menu_state);
 
+    void setIdleView(IdleView view);
+    [[nodiscard]] IdleView getIdleView() const;
+    void addScopeSample(const Utils::DrumScope::Sample &sample);
+
     void showIdle();
     void showMenu();
 
     void update();
+
+    // Time needed to draw a frame into the framebuffer since the last call, sending it is not included.
+    Utils::TimingStats takeRenderTime();
+
+    // Frames are sent via DMA in chunks, other devices may only use the I2C bus once the current chunk is done.
+    // See I2cBus for scheduling.
+    [[nodiscard]] bool isChunkDone();
+    void sendChunk();
 };
 
 } // namespace Doncon::Peripherals
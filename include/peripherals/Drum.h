@@ -2,19 +2,77 @@
 #define PERIPHERALS_DRUM_H_
 
 #include "utils/InputState.h"
+#include "utils/TimingStats.h"
 
 #include "hardware/spi.h"
+#include <mcp3204/Mcp3204Dma.h>
 
 #include <array>
 #include <cstdint>
-#include <deque>
-#include <map>
-#include <memory>
-#include <variant>
+#include <tuple>
+#include <utility>
 
 namespace Doncon::Peripherals {
 
-class Drum {
+// Averaged reads from the RP2040 internal ADC.
+class InternalAdc {
+  public:
+    struct Config {
+        uint8_t sample_count;
+    };
+
+  private:
+    Config m_config;
+
+  public:
+    InternalAdc(const Config &config);
+
+    // Those are 12bit values
+    std::array<uint16_t, 4> read();
+
+    // Sampling happens synchronously in read(), so its timing equals the core 0 loop timing.
+    Utils::TimingStats takeSampleIntervals() { return {}; }
+
+    // Sampling happens on core 0, nothing can continue while flash is busy.
+    static uint32_t getRamIrqMask() { return 0; }
+};
+
+// Peak values from an external MCP3204 ADC, continuously sampled via DMA.
+class ExternalAdc {
+  public:
+    struct Config {
+        spi_inst_t *spi_block;
+        uint spi_speed_hz;
+        uint8_t spi_mosi_pin;
+        uint8_t spi_miso_pin;
+        uint8_t spi_sclk_pin;
+        uint8_t spi_scsn_pin;
+        uint8_t spi_level_shifter_enable_pin;
+    };
+
+    ExternalAdc(const Config &config);
+
+    // Those are 12bit values
+    std::array<uint16_t, 4> read() { return Mcp3204Dma::take_maximums(); }
+
+    // Time between two consecutive conversions since the last call.
+    Utils::TimingStats takeSampleIntervals() {
+        const auto stats = Mcp3204Dma::take_interval_stats();
+        return {.min_us = stats.min_us, .max_us = stats.max_us, .sum_us = stats.sum_us, .count = stats.count};
+    }
+
+    // Interrupts which keep sampling while flash is busy, requires the sampling code to run from SRAM.
+    static uint32_t getRamIrqMask() {
+#if MCP3204_DMA_IN_RAM
+        return Mcp3204Dma::get_irq_mask();
+#else
+        return 0;
+#endif
+    }
+};
+
+// ADC independent part of the drum logic, see Drum for the actual peripheral.
+class DrumBase {
   public:
     struct Config {
         struct __attribute((packed, aligned(1))) Thresholds {
@@ -31,20 +89,6 @@ class Drum {
             uint8_t ka_right;
         };
 
-        struct InternalAdc {
-            uint8_t sample_count;
-        };
-
-        struct ExternalAdc {
-            spi_inst_t *spi_block;
-            uint spi_speed_hz;
-            uint8_t spi_mosi_pin;
-            uint8_t spi_miso_pin;
-            uint8_t spi_sclk_pin;
-            uint8_t spi_scsn_pin;
-            uint8_t spi_level_shifter_enable_pin;
-        };
-
         enum class DoubleTriggerMode : uint8_t {
             Off,
             Threshold,
@@ -61,7 +105,6 @@ class Drum {
         uint32_t roll_counter_timeout_ms;
 
         AdcChannels adc_channels;
-        std::variant<InternalAdc, ExternalAdc> adc_config;
     };
 
   private:
@@ -71,18 +114,38 @@ class Drum {
         DON_RIGHT,
         KA_RIGHT,
     };
+    static constexpr size_t PAD_COUNT = 4;
+
+  protected:
+    static constexpr size_t ADC_CHANNEL_COUNT = 4;
+
+    using AdcValues = std::array<uint16_t, ADC_CHANNEL_COUNT>;
+
+  private:
+    using RawValues = std::array<uint16_t, PAD_COUNT>;
 
     class Pad {
       private:
+        // Maximum value of each millisecond, timestamp is the time_us_32() of its first sample.
         struct analog_buffer_entry {
             uint16_t value;
             uint32_t timestamp;
         };
 
+        // Covers the longest debounce delay settable in the menu, longer delays are limited to this.
+        static constexpr size_t ANALOG_BUFFER_CAPACITY = 256;
+        static_assert((ANALOG_BUFFER_CAPACITY & (ANALOG_BUFFER_CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
         uint8_t m_channel;
-        uint32_t m_last_change{0};
+        uint32_t m_last_change{0}; // in us
         bool m_active{false};
-        std::deque<analog_buffer_entry> m_analog_buffer;
+        std::array<analog_buffer_entry, ANALOG_BUFFER_CAPACITY> m_analog_buffer{};
+        size_t m_analog_buffer_head{0};
+        size_t m_analog_buffer_count{0};
+
+        analog_buffer_entry &analogEntry(size_t idx) {
+            return m_analog_buffer[(m_analog_buffer_head + idx) & (ANALOG_BUFFER_CAPACITY - 1)];
+        }
 
       public:
         Pad(uint8_t channel);
@@ -98,16 +161,11 @@ class Drum {
       private:
         uint32_t m_timeout_ms;
 
-        uint32_t m_last_hit_time{0};
+        uint32_t m_last_hit_time{0}; // in us
         uint16_t m_current_roll{0};
         uint16_t m_previous_roll{0};
 
-        struct {
-            bool don_left;
-            bool ka_left;
-            bool don_right;
-            bool ka_right;
-        } m_previous_pad_state{};
+        uint32_t m_previous_triggered{0};
 
       public:
         RollCounter(uint32_t timeout_ms);
@@ -117,50 +175,47 @@ class Drum {
         [[nodiscard]] uint16_t getPreviousRoll() const { return m_previous_roll; };
     };
 
-    // NOLINTNEXTLINE(cppcoreguidelines-special-member-functions): Class has no members
-    class AdcInterface {
-      public:
-        virtual ~AdcInterface() = default;
+    Config m_config;
+    std::array<Pad, PAD_COUNT> m_pads;
+    RollCounter m_roll_counter;
 
-        // Those are expected to be 12bit values
-        virtual std::array<uint16_t, 4> read() = 0;
-    };
+    static Utils::InputState::Input toInput(Id id);
 
-    class InternalAdc : public AdcInterface {
-      private:
-        Config::InternalAdc m_config;
+    Pad &pad(Id id) { return m_pads[static_cast<size_t>(id)]; }
+    static uint16_t raw(const RawValues &raw_values, Id id) { return raw_values[static_cast<size_t>(id)]; }
 
-      public:
-        InternalAdc(const Config::InternalAdc &config);
-        std::array<uint16_t, 4> read() final;
-    };
+    void updateDigitalInputState(Utils::InputState &input_state, const RawValues &raw_values);
+    void updateAnalogInputState(Utils::InputState &input_state, const RawValues &raw_values);
 
-    class ExternalAdc : public AdcInterface {
-      public:
-        ExternalAdc(const Config::ExternalAdc &config);
-        std::array<uint16_t, 4> read() final;
-    };
+  protected:
+    DrumBase(const Config &config);
 
-    Config m_config;
-    std::unique_ptr<AdcInterface> m_adc;
-    std::map<Id, Pad> m_pads;
-    RollCounter m_roll_counter;
-
-    void updateDigitalInputState(Utils::InputState &input_state, const std::map<Id, uint16_t> &raw_values);
-    void updateAnalogInputState(Utils::InputState &input_state, const std::map<Id, uint16_t> &raw_values);
-    std::map<Id, uint16_t> readInputs();
+    void updateInputState(Utils::InputState &input_state, const AdcValues &adc_values);
 
   public:
-    Drum(const Config &config);
-
-    void updateInputState(Utils::InputState &input_state);
-
     void setDebounceDelay(uint16_t delay);
     void setTriggerThresholds(const Config::Thresholds &thresholds);
     void setDoubleTriggerMode(Config::DoubleTriggerMode mode);
     void setDoubleThresholds(const Config::Thresholds &thresholds);
 };
 
+// Drum peripheral reading from ADC backend TAdc, which is either InternalAdc or ExternalAdc. The backend is
+// fixed at compile time, so reads can be inlined.
+template <typename TAdc> class Drum : public DrumBase {
+  private:
+    TAdc m_adc;
+
+    static_assert(std::tuple_size_v<decltype(std::declval<TAdc &>().read())> == ADC_CHANNEL_COUNT,
+                  "ADC backend must provide a value for each channel");
+
+  public:
+    Drum(const Config &config, const typename TAdc::Config &adc_config) : DrumBase(config), m_adc(adc_config) {}
+
+    void updateInputState(Utils::InputState &input_state) { DrumBase::updateInputState(input_state, m_adc.read()); }
+
+    Utils::TimingStats takeSampleIntervals() { return m_adc.takeSampleIntervals(); }
+};
+
 } // namespace Doncon::Peripherals
 
 #endif // PERIPHERALS_DRUM_H_
\ No newline at end of file
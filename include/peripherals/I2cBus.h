@@ -0,0 +1,54 @@
+#ifndef PERIPHERALS_I2CBUS_H_
+#define PERIPHERALS_I2CBUS_H_
+
+#include "utils/TimingStats.h"
+
+#include "pico.h"
+#include "pico/time.h"
+
+#include <cstdint>
+
+namespace Doncon::Peripherals {
+
+// Schedules transactions on an I2C block shared by a foreground and a background client, i.e. the button
+// expander and the display. Foreground transactions have strict priority, they only wait for the background
+// chunk currently on the bus. The background client sends its transfers in short chunks whenever the bus is
+// free, so a foreground transaction is delayed by at most one chunk.
+//
+// TBackground needs to provide isChunkDone() and sendChunk().
+template <typename TBackground> class I2cBus {
+  private:
+    TBackground &m_background;
+    Utils::TimingStats m_foreground_latency;
+
+  public:
+    I2cBus(TBackground &background) : m_background(background) {}
+
+    template <typename TTransaction> void runForeground(TTransaction transaction) {
+        const uint32_t start_us = time_us_32();
+
+        while (!m_background.isChunkDone()) {
+            tight_loop_contents();
+        }
+        transaction();
+
+        m_foreground_latency.record(time_us_32() - start_us);
+    }
+
+    void runBackground() {
+        if (m_background.isChunkDone()) {
+            m_background.sendChunk();
+        }
+    }
+
+    // Time from requesting a foreground transaction until it completed, including the wait for the bus.
+    Utils::TimingStats takeForegroundLatency() {
+        const auto stats = m_foreground_latency;
+        m_foreground_latency.reset();
+        return stats;
+    }
+};
+
+} // namespace Doncon::Peripherals
+
+#endif // PERIPHERALS_I2CBUS_H_
\ No newline at end of file
@@ -2,9 +2,12 @@
 #define PERIPHERALS_STATUSLED_H_
 
 #include "utils/InputState.h"
+#include "utils/TimingStats.h"
 
+#include <array>
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 namespace Doncon::Peripherals {
 
@@ -17,26 +20,69 @@ class StatusLed {
             uint8_t b;
         };
 
+        // Range of LEDs on the strip lit by a pad.
+        struct Zone {
+            uint16_t first;
+            uint16_t count;
+        };
+
         Color idle_color;
         Color don_left_color;
         Color ka_left_color;
         Color don_right_color;
         Color ka_right_color;
+        Color roll_color;
 
         uint8_t led_enable_pin;
         uint8_t led_pin;
+        uint16_t led_count;
         bool is_rgbw;
 
+        struct {
+            Zone don_left;
+            Zone ka_left;
+            Zone don_right;
+            Zone ka_right;
+        } zones;
+
+        uint16_t frame_rate;      // Frames per second
+        uint16_t trail_ms;        // Fade out time after releasing a full strength hit, shorter for softer hits
+        uint16_t roll_full_speed; // Hits per second at which rolling pads are fully shown in roll_color
+
         uint8_t brightness;
         bool enable_player_color;
     };
 
   private:
+    struct Pad {
+        bool active;
+        uint8_t velocity;
+        uint32_t release_us;
+        uint32_t trail_us;
+    };
+
     Config m_config;
 
     Utils::InputState m_input_state;
     std::optional<Config::Color> m_player_color;
 
+    Utils::InputState::PadArray<Config::Zone> m_zones;
+    Utils::InputState::PadArray<Config::Color> m_colors;
+    Utils::InputState::PadArray<Pad> m_pads{};
+    uint32_t m_roll_start_us{0};
+
+    uint32_t m_frame_interval_us;
+    uint32_t m_last_frame_us{0};
+    Utils::TimingStats m_frame_time;
+
+    std::array<uint8_t, 256> m_brightness_lut{};
+    std::vector<uint32_t> m_frame;
+    bool m_frame_pending{true};
+
+    void updatePads(uint32_t now_us);
+    [[nodiscard]] uint8_t getRollRamp(uint32_t now_us) const;
+    void render(uint32_t now_us);
+
   public:
     StatusLed(const Config &config);
 
@@ -46,7 +92,14 @@ class StatusLed {
     void setInputState(const Utils::InputState &input_state);
     void setPlayerColor(const Config::Color &color);
 
+    // Tracks hits on every call, but only renders a new frame at the configured frame rate.
     void update();
+    // Whether update() returns without waiting for the strip, it sleeps while sending frames if no DMA channel
+    // was available.
+    [[nodiscard]] bool isNonBlocking() const;
+
+    // Time needed to render and send a frame since the last call.
+    Utils::TimingStats takeFrameTime();
 };
 
 } // namespace Doncon::Peripherals
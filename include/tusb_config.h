@@ -52,7 +52,7 @@ extern "C" {
 
 // Device class buffer sizes
 #define CFG_TUD_CDC_RX_BUFSIZE (TUD_OPT_HIGH_SPEED ? 512 : 64)
-#define CFG_TUD_CDC_TX_BUFSIZE (TUD_OPT_HIGH_SPEED ? 512 : 64)
+#define CFG_TUD_CDC_TX_BUFSIZE (1024) // Large enough to hold a full capture frame
 #define CFG_TUD_CDC_EP_BUFSIZE (TUD_OPT_HIGH_SPEED ? 512 : 64)
 
 #define CFG_TUD_HID_EP_BUFSIZE (64) // NOLINT(cppcoreguidelines-macro-to-enum,modernize-macro-to-enum)
@@ -15,7 +15,8 @@ enum {
     PS4_AUTH_SERIAL_LENGTH = 16,
 };
 
-typedef void (*ps4_auth_sign_cb_t)(const uint8_t[PS4_AUTH_CHALLENGE_LENGTH]);
+// request identifies the challenge, pass it back with the signature to ps4_auth_set_signed_challenge().
+typedef void (*ps4_auth_sign_cb_t)(const uint8_t[PS4_AUTH_CHALLENGE_LENGTH], uint32_t request);
 
 void ps4_auth_init(const char *private_key, size_t private_key_len, const uint8_t serial[PS4_AUTH_SERIAL_LENGTH],
                    const uint8_t ca_signature[PS4_AUTH_SIGNATURE_LENGTH], ps4_auth_sign_cb_t sign_cb);
@@ -26,7 +27,8 @@ uint16_t ps4_auth_get_challenge_state_report(uint8_t report_id, uint8_t *buffer)
 uint16_t ps4_auth_get_challenge_report(uint8_t report_id, uint8_t *buffer);
 uint16_t ps4_auth_get_reset_report(uint8_t report_id, uint8_t *buffer);
 
-void ps4_auth_set_signed_challenge(const uint8_t singed_challenge[PS4_AUTH_CHALLENGE_LENGTH]);
+// Signatures of requests superseded by a new challenge or a reset in the meantime are ignored.
+void ps4_auth_set_signed_challenge(const uint8_t singed_challenge[PS4_AUTH_CHALLENGE_LENGTH], uint32_t request);
 
 #ifdef __cplusplus
 }
@@ -27,6 +27,7 @@ typedef enum {
     USB_MODE_XBOX360_ANALOG_P2,
     USB_MODE_MIDI,
     USB_MODE_DEBUG,
+    USB_MODE_CAPTURE,
 } usb_mode_t;
 
 enum {
@@ -75,11 +76,15 @@ extern char *const usbd_desc_str[];
 typedef void (*usbd_player_led_cb_t)(usb_player_led_t);
 
 void usbd_driver_init(usb_mode_t mode);
+// Re-enumerates in a different mode without rebooting, completes within usbd_driver_task().
+void usbd_driver_switch_mode(usb_mode_t mode);
 void usbd_driver_task();
 
 usb_mode_t usbd_driver_get_mode();
+// Whether a host is connected and polls for reports, i.e. the device is mounted and not suspended.
+bool usbd_driver_is_host_active();
 
-void usbd_driver_send_report(usb_report_t report);
+bool usbd_driver_send_report(usb_report_t report);
 
 void usbd_driver_set_player_led_cb(usbd_player_led_cb_t cb);
 usbd_player_led_cb_t usbd_driver_get_player_led_cb();
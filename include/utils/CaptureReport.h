@@ -0,0 +1,64 @@
+#ifndef UTILS_CAPTUREREPORT_H_
+#define UTILS_CAPTUREREPORT_H_
+
+#include "usb/device_driver.h"
+
+#include <mcp3204/Mcp3204Dma.h>
+
+#include <array>
+#include <cstdint>
+
+namespace Doncon::Utils {
+
+// Packs raw ADC samples into binary frames for streaming over CDC, see scripts/decodeCapture.py for a host side
+// decoder. All values are little endian.
+//
+// Frame layout:
+//   Header  (12 bytes)
+//   Samples (4 bytes each, count as given in header)
+class CaptureReport {
+  public:
+    static constexpr uint16_t SYNC_WORD = 0xCA9E;
+    static constexpr size_t MAX_SAMPLES = 120;
+
+    struct __attribute((packed, aligned(1))) Header {
+        uint16_t sync;         // Always SYNC_WORD
+        uint16_t sequence;     // Incremented by one for each frame
+        uint32_t timestamp_us; // Time of the first sample in the frame
+        uint16_t dropped;      // Samples lost before this frame, saturating
+        uint8_t count;         // Number of samples following the header
+        uint8_t checksum;      // Sum of all frame bytes with this field set to zero
+    };
+
+    struct __attribute((packed, aligned(1))) Sample {
+        uint16_t offset_us; // Relative to the header timestamp
+        uint16_t value;     // Bits 15-14: ADC channel, bits 11-0: ADC value
+    };
+
+  private:
+    struct __attribute((packed, aligned(1))) Frame {
+        Header header;
+        std::array<Sample, MAX_SAMPLES> samples;
+    };
+
+    Frame m_frame{};
+    std::array<Mcp3204Dma::Sample, MAX_SAMPLES> m_sample_buffer{};
+    uint16_t m_frame_size{0};
+    bool m_pending{false};
+    uint32_t m_last_dropped{0};
+
+    void buildFrame();
+
+  public:
+    CaptureReport() = default;
+
+    void setEnabled(bool enabled);
+
+    // Returns the pending frame if it was not confirmed yet, otherwise a new one.
+    usb_report_t getReport();
+    void confirm();
+};
+
+} // namespace Doncon::Utils
+
+#endif // UTILS_CAPTUREREPORT_H_
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef UTILS_DRUMSCOPE_H_
+#define UTILS_DRUMSCOPE_H_
+
+#include "utils/InputState.h"
+#include "utils/SampleRing.h"
+
+#include <cstdint>
+
+namespace Doncon::Utils {
+
+// Decimated drum signals for the scope and timeline views of the display. Core 0 adds every drum state and
+// publishes the peak values of each interval, core 1 takes them without ever blocking the sampling.
+class DrumScope {
+  public:
+    struct Sample {
+        InputState::PadArray<uint16_t> raw;
+        uint32_t triggered;
+    };
+
+    static constexpr uint32_t SAMPLE_INTERVAL_US = 1000;
+
+  private:
+    SampleRing<Sample, 128> m_ring;
+
+    Sample m_pending{};
+    uint32_t m_pending_start_us{0};
+
+  public:
+    // Called from core 0 only
+    void add(const InputState::Drum &drum);
+
+    // Called from core 1 only
+    bool take(Sample &sample) { return m_ring.pop(sample); }
+};
+
+} // namespace Doncon::Utils
+
+#endif // UTILS_DRUMSCOPE_H_
\ No newline at end of file
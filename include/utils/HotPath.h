@@ -0,0 +1,23 @@
+#ifndef UTILS_HOTPATH_H_
+#define UTILS_HOTPATH_H_
+
+// Placement of code and data on the latency critical path from ADC sample to USB report.
+//
+// With DONCON_HOT_PATHS_IN_RAM enabled, marked functions and lookup tables are copied to SRAM at boot. This
+// avoids XIP cache misses, which core 1 regularly provokes while driving the display, LEDs and PS4 signing.
+
+#if DONCON_HOT_PATHS_IN_RAM
+
+#include "pico.h"
+
+#define HOT_PATH_FUNC(func_name) __not_in_flash_func(func_name)
+#define HOT_PATH_RODATA __not_in_flash("hot_path_rodata")
+
+#else
+
+#define HOT_PATH_FUNC(func_name) func_name
+#define HOT_PATH_RODATA
+
+#endif
+
+#endif // UTILS_HOTPATH_H_
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef UTILS_INPUTREMAP_H_
+#define UTILS_INPUTREMAP_H_
+
+#include "utils/InputState.h"
+
+#include <array>
+#include <cstdint>
+
+namespace Doncon::Utils {
+
+// Runtime remap layer for digital inputs, applied to InputState::digital() before report packing. Per pad
+// values like the analog levels move along with their pad, a pad which is reported from a button has none.
+class InputRemap {
+  public:
+    // Index is the physical input, value the input it is reported as. Anything but a permutation is
+    // treated as identity, so that uninitialized storage falls back to the default mapping.
+    using Mapping = std::array<InputState::Input, InputState::INPUT_COUNT>;
+
+    static constexpr Mapping identity() {
+        Mapping mapping{};
+        for (size_t i = 0; i < mapping.size(); ++i) {
+            mapping[i] = static_cast<InputState::Input>(i);
+        }
+        return mapping;
+    }
+
+    static bool isValid(const Mapping &mapping);
+
+  private:
+    static constexpr size_t LUT_COUNT = (InputState::INPUT_COUNT + 7) / 8;
+
+    Mapping m_mapping{identity()};
+    std::array<std::array<uint32_t, 256>, LUT_COUNT> m_luts{};
+    InputState::PadArray<uint8_t> m_pad_sources{}; // Physical pad of each reported pad, PAD_COUNT if none
+    bool m_is_identity{true};
+
+  public:
+    InputRemap() = default;
+
+    void setMapping(const Mapping &mapping);
+
+    [[nodiscard]] uint32_t apply(const uint32_t digital) const {
+        if (m_is_identity) {
+            return digital;
+        }
+
+        uint32_t result = 0;
+        for (size_t i = 0; i < LUT_COUNT; ++i) {
+            result |= m_luts[i][(digital >> (i * 8)) & 0xFF];
+        }
+        return result;
+    }
+
+    [[nodiscard]] InputState::PadArray<uint16_t> applyPads(const InputState::PadArray<uint16_t> &values) const {
+        if (m_is_identity) {
+            return values;
+        }
+
+        InputState::PadArray<uint16_t> result{};
+        for (size_t pad = 0; pad < result.size(); ++pad) {
+            result[pad] = m_pad_sources[pad] < values.size() ? values[m_pad_sources[pad]] : 0;
+        }
+        return result;
+    }
+};
+
+} // namespace Doncon::Utils
+
+#endif // UTILS_INPUTREMAP_H_
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef UTILS_INPUTREPORT_H_
 #define UTILS_INPUTREPORT_H_
 
+#include "utils/InputRemap.h"
 #include "utils/InputState.h"
+#include "utils/TextBuffer.h"
 
 #include "usb/device/hid/keyboard_driver.h"
 #include "usb/device/hid/ps3_driver.h"
@@ -12,7 +14,6 @@
 #include "usb/device_driver.h"
 
 #include <cstdint>
-#include <string>
 
 namespace Doncon::Utils {
 
@@ -107,23 +108,27 @@ struct InputReport {
         .status = {},
         .velocity = {},
     };
-    std::string m_debug_report;
+    TextBuffer<80> m_debug_report;
 
     uint8_t m_ps4_report_counter = 0;
 
-    usb_report_t getSwitchReport(const InputState &state);
-    usb_report_t getPS3Report(const InputState &state);
-    usb_report_t getPS4Report(const InputState &state);
-    usb_report_t getKeyboardReport(const InputState &state, Player player);
-    usb_report_t getXinputBaseReport(const InputState &state);
-    usb_report_t getXinputDigitalReport(const InputState &state);
-    usb_report_t getXinputAnalogReport(const InputState &state, Player player);
-    usb_report_t getMidiReport(const InputState &state);
-    usb_report_t getDebugReport(const InputState &state);
+    InputRemap m_input_remap;
+
+    usb_report_t getSwitchReport(uint32_t digital);
+    usb_report_t getPS3Report(uint32_t digital);
+    usb_report_t getPS4Report(uint32_t digital);
+    usb_report_t getKeyboardReport(uint32_t digital, Player player);
+    usb_report_t getXinputBaseReport(uint32_t digital);
+    usb_report_t getXinputDigitalReport(uint32_t digital);
+    usb_report_t getXinputAnalogReport(const InputState::PadArray<uint16_t> &analog, uint32_t digital, Player player);
+    usb_report_t getMidiReport(const InputState::PadArray<uint16_t> &analog, uint32_t digital);
+    usb_report_t getDebugReport(const InputState::PadArray<uint16_t> &raw, uint32_t digital);
 
   public:
     InputReport() = default;
 
+    void setInputRemap(const InputRemap::Mapping &mapping);
+
     usb_report_t getReport(const InputState &state, usb_mode_t mode);
 };
 
@@ -1,42 +1,77 @@
 #ifndef UTILS_INPUTSTATE_H_
 #define UTILS_INPUTSTATE_H_
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace Doncon::Utils {
 
 struct InputState {
   public:
-    struct Drum {
-        struct Pad {
-            bool triggered;
-            uint16_t analog;
-            uint16_t raw;
-        };
+    // Bit positions of all digital inputs. Drum and controller share the
+    // same bit space, so their masks can simply be combined.
+    enum class Input : uint8_t {
+        DonLeft,
+        KaLeft,
+        DonRight,
+        KaRight,
+        Up,
+        Down,
+        Left,
+        Right,
+        North,
+        East,
+        South,
+        West,
+        L,
+        R,
+        Start,
+        Select,
+        Home,
+        Share,
+    };
+    static constexpr size_t INPUT_COUNT = static_cast<size_t>(Input::Share) + 1;
+    static constexpr size_t PAD_COUNT = static_cast<size_t>(Input::KaRight) + 1;
+
+    static constexpr uint32_t bit(const Input input) { return 1U << static_cast<uint8_t>(input); }
+
+    // Per pad values, indexable by the pads Input.
+    template <typename T> struct PadArray : std::array<T, PAD_COUNT> {
+        using std::array<T, PAD_COUNT>::operator[];
 
-        Pad don_left, ka_left, don_right, ka_right;
+        constexpr T &operator[](const Input pad) { return (*this)[static_cast<size_t>(pad)]; }
+        constexpr const T &operator[](const Input pad) const { return (*this)[static_cast<size_t>(pad)]; }
+    };
+
+    struct Drum {
+        uint32_t triggered;
+        PadArray<uint16_t> analog;
+        PadArray<uint16_t> raw;
         uint16_t current_roll;
         uint16_t previous_roll;
+
+        [[nodiscard]] bool isTriggered(const Input pad) const { return (triggered & bit(pad)) != 0; }
+
+        bool operator==(const Drum &other) const = default;
     };
 
     struct Controller {
-        struct DPad {
-            bool up, down, left, right;
-        };
-
-        struct Buttons {
-            bool north, east, south, west;
-            bool l, r;
-            bool start, select, home, share;
-        };
-
-        DPad dpad;
-        Buttons buttons;
+        uint32_t buttons;
+
+        [[nodiscard]] bool isPressed(const Input button) const { return (buttons & bit(button)) != 0; }
+
+        bool operator==(const Controller &other) const = default;
     };
 
     Drum drum{};
     Controller controller{};
 
+    // Returns all digital inputs as bitmask, indexed by Input.
+    [[nodiscard]] uint32_t digital() const { return drum.triggered | controller.buttons; }
+
+    bool operator==(const InputState &other) const = default;
+
     void releaseAll() {
         drum = {};
         controller = {};
@@ -4,11 +4,11 @@
 #include "utils/InputState.h"
 #include "utils/SettingsStore.h"
 
+#include <array>
 #include <map>
 #include <memory>
+#include <span>
 #include <stack>
-#include <string>
-#include <vector>
 
 namespace Doncon::Utils {
 
@@ -18,14 +18,17 @@ class Menu {
         Main,
 
         DeviceMode,
+        Profile,
         Drum,
         Led,
+        InputRemap,
         Reset,
         Bootsel,
 
         DrumDebounceDelay,
         DrumTriggerThresholds,
         DrumDoubleTrigger,
+        DrumSignalMeter,
 
         DrumTriggerThresholdKaLeft,
         DrumTriggerThresholdDonLeft,
@@ -44,6 +47,7 @@ class Menu {
 
         BootselMsg,
     };
+    static constexpr size_t PAGE_COUNT = static_cast<size_t>(Page::BootselMsg) + 1;
 
     struct State {
         Page page;
@@ -57,6 +61,7 @@ class Menu {
             Selection,
             Value,
             Toggle,
+            Meter,
             RebootInfo,
         };
 
@@ -65,8 +70,10 @@ class Menu {
             GotoParent,
 
             GotoPageDeviceMode,
+            GotoPageProfile,
             GotoPageDrum,
             GotoPageLed,
+            GotoPageInputRemap,
             GotoPageReset,
             GotoPageBootsel,
 
@@ -74,6 +81,7 @@ class Menu {
             GotoPageDrumDoubleTrigger,
             GotoPageDrumTriggerThresholds,
             GotoPageDrumDoubleTriggerThresholds,
+            GotoPageDrumSignalMeter,
 
             GotoPageDrumTriggerThresholdKaLeft,
             GotoPageDrumTriggerThresholdDonLeft,
@@ -89,6 +97,8 @@ class Menu {
             GotoPageLedEnablePlayerColor,
 
             SetUsbMode,
+            SetProfile,
+            SetInputRemap,
 
             SetDrumDebounceDelay,
 
@@ -112,13 +122,21 @@ class Menu {
             DoRebootToBootsel,
         };
 
+        struct Item {
+            const char *name;
+            Action action;
+        };
+
         Type type;
-        std::string name;
-        std::vector<std::pair<std::string, Action>> items;
+        const char *name;
+        std::span<const Item> items;
         uint16_t max_value;
     };
 
-    const static std::map<Page, const Descriptor> descriptors;
+    // Constant initialized and indexed by Page, use getDescriptor().
+    const static std::array<Descriptor, PAGE_COUNT> descriptors;
+
+    static const Descriptor &getDescriptor(const Page page) { return descriptors[static_cast<size_t>(page)]; }
 
   private:
     class Buttons {
@@ -146,6 +164,8 @@ class Menu {
 
         void update(const InputState::Controller &state);
         [[nodiscard]] bool getPressed(Id id) const;
+        // Step size for values that span a large range, it grows the longer the button is held.
+        [[nodiscard]] uint16_t getStep(Id id) const;
     };
 
     std::shared_ptr<SettingsStore> m_store;
@@ -159,6 +179,7 @@ class Menu {
     void gotoParent(bool do_restore);
 
     void performAction(Descriptor::Action action, uint16_t value);
+    void stepMeterThreshold(uint16_t pad, int32_t step);
 
   public:
     Menu(std::shared_ptr<SettingsStore> settings_store);
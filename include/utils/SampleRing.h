@@ -0,0 +1,49 @@
+#ifndef UTILS_SAMPLERING_H_
+#define UTILS_SAMPLERING_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Doncon::Utils {
+
+// Lock-free ring buffer for exactly one producer and one consumer, e.g. on different cores. The producer never
+// waits, push() drops the value if the consumer fell behind.
+template <typename T, size_t TCapacity> class SampleRing {
+    static_assert(TCapacity > 0 && (TCapacity & (TCapacity - 1)) == 0, "Capacity must be a power of two");
+
+  private:
+    std::array<T, TCapacity> m_items{};
+    std::atomic<uint32_t> m_head{0}; // Only written by the producer
+    std::atomic<uint32_t> m_tail{0}; // Only written by the consumer
+
+  public:
+    bool push(const T &item) {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= TCapacity) {
+            return false;
+        }
+
+        m_items[head & (TCapacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool pop(T &item) {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = m_items[tail & (TCapacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+};
+
+} // namespace Doncon::Utils
+
+#endif // UTILS_SAMPLERING_H_
\ No newline at end of file
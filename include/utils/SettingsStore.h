@@ -3,38 +3,121 @@
 
 #include "peripherals/Drum.h"
 #include "usb/device_driver.h"
+#include "utils/InputRemap.h"
+#include "utils/TimingStats.h"
 
 #include "hardware/flash.h"
 
 #include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
 
 namespace Doncon::Utils {
 
 class SettingsStore {
+  public:
+    static constexpr size_t PROFILE_COUNT = 4;
+
   private:
-    const static uint32_t m_flash_size = FLASH_SECTOR_SIZE;
+    // Settings are persisted as an append-only journal of CRC checked records. Only one sector is active at a
+    // time, once it is full all current values are compacted into the next sector. Sectors are used round robin
+    // for wear leveling. Erases stall USB for tens of milliseconds, stale sectors are only erased while the host is
+    // not reading reports or right after a store() from the menu.
+    const static uint32_t m_sector_count = 4;
+    const static uint32_t m_flash_size = m_sector_count * FLASH_SECTOR_SIZE;
     const static uint32_t m_flash_offset = PICO_FLASH_SIZE_BYTES - m_flash_size;
-    const static uint32_t m_store_size = FLASH_PAGE_SIZE;
-    const static uint32_t m_store_pages = m_flash_size / m_store_size;
-    const static uint8_t m_magic_byte = 0x39;
+    const static uint32_t m_sector_magic = 0x4A4E4F44; // "DONJ"
+    const static uint32_t m_idle_delay_ms = 5000;
+
+    // Persisted record keys, never reuse or renumber them. Incompatible changes to a value need a new version.
+    // Drum settings exist once per profile, the key of profile n is the base key + n * m_profile_key_stride.
+    enum class Key : uint8_t {
+        UsbMode = 0x01,
+        TriggerThresholds = 0x02,
+        LedBrightness = 0x03,
+        LedEnablePlayerColor = 0x04,
+        DebounceDelay = 0x05,
+        DoubleTriggerMode = 0x06,
+        DoubleTriggerThresholds = 0x07,
+        InputRemap = 0x08,
+        ActiveProfile = 0x09,
+    };
+    const static uint8_t m_profile_key_stride = 0x10;
+
+    struct __attribute((packed, aligned(1))) SectorHeader {
+        uint32_t magic;
+        uint32_t sequence;
+    };
+
+    struct __attribute((packed, aligned(1))) RecordHeader {
+        Key key;
+        uint8_t version;
+        uint8_t length;
+        uint16_t crc; // CRC-16/CCITT over key, version, length and value
+    };
+
+    struct Profile {
+        Peripherals::DrumBase::Config::Thresholds trigger_thresholds;
+        uint16_t debounce_delay;
+        Peripherals::DrumBase::Config::DoubleTriggerMode double_trigger_mode;
+        Peripherals::DrumBase::Config::Thresholds double_trigger_thresholds;
+    };
 
-    struct __attribute((packed, aligned(1))) Storecache {
-        uint8_t in_use;
+    struct Storecache {
         usb_mode_t usb_mode;
-        Peripherals::Drum::Config::Thresholds trigger_thresholds;
         uint8_t led_brightness;
         bool led_enable_player_color;
-        uint16_t debounce_delay;
-        Peripherals::Drum::Config::DoubleTriggerMode double_trigger_mode;
-        Peripherals::Drum::Config::Thresholds double_trigger_thresholds;
-
-        std::array<uint8_t, m_store_size - sizeof(uint8_t) - sizeof(usb_mode_t) -
-                                sizeof(Peripherals::Drum::Config::Thresholds) - sizeof(uint8_t) - sizeof(bool) -
-                                sizeof(uint16_t) - sizeof(Peripherals::Drum::Config::DoubleTriggerMode) -
-                                sizeof(Peripherals::Drum::Config::Thresholds)>
-            _padding;
+        InputRemap::Mapping input_remap;
+        uint8_t active_profile;
+        std::array<Profile, PROFILE_COUNT> profiles;
+    };
+
+    struct Field {
+        Key key;
+        uint8_t version;
+        size_t offset;
+        size_t size;
     };
-    static_assert(sizeof(Storecache) == m_store_size);
+
+    static constexpr Key getProfileKey(Key key, size_t profile) {
+        return static_cast<Key>(static_cast<uint8_t>(key) + (profile * m_profile_key_stride));
+    }
+
+    static constexpr size_t FIELD_COUNT = 5 + (4 * PROFILE_COUNT);
+    static constexpr std::array<Field, FIELD_COUNT> m_fields = [] {
+        // Same as getProfileKey(), which can't be called before the class is complete.
+        const auto profile_key = [](Key key, size_t profile) {
+            return static_cast<Key>(static_cast<uint8_t>(key) + (profile * m_profile_key_stride));
+        };
+
+        std::array<Field, FIELD_COUNT> fields = {{
+            {Key::UsbMode, 1, offsetof(Storecache, usb_mode), sizeof(Storecache::usb_mode)},
+            {Key::LedBrightness, 1, offsetof(Storecache, led_brightness), sizeof(Storecache::led_brightness)},
+            {Key::LedEnablePlayerColor, 1, offsetof(Storecache, led_enable_player_color),
+             sizeof(Storecache::led_enable_player_color)},
+            {Key::InputRemap, 1, offsetof(Storecache, input_remap), sizeof(Storecache::input_remap)},
+            {Key::ActiveProfile, 1, offsetof(Storecache, active_profile), sizeof(Storecache::active_profile)},
+        }};
+
+        for (size_t profile = 0; profile < PROFILE_COUNT; ++profile) {
+            const size_t base = offsetof(Storecache, profiles) + (profile * sizeof(Profile));
+            auto *field = &fields[5 + (profile * 4)];
+
+            *field++ = {profile_key(Key::TriggerThresholds, profile), 1, base + offsetof(Profile, trigger_thresholds),
+                        sizeof(Profile::trigger_thresholds)};
+            *field++ = {profile_key(Key::DebounceDelay, profile), 1, base + offsetof(Profile, debounce_delay),
+                        sizeof(Profile::debounce_delay)};
+            *field++ = {profile_key(Key::DoubleTriggerMode, profile), 1,
+                        base + offsetof(Profile, double_trigger_mode), sizeof(Profile::double_trigger_mode)};
+            *field = {profile_key(Key::DoubleTriggerThresholds, profile), 1,
+                      base + offsetof(Profile, double_trigger_thresholds), sizeof(Profile::double_trigger_thresholds)};
+        }
+
+        return fields;
+    }();
+    static_assert(FIELD_COUNT <= 32, "Dirty tracking is limited to 32 fields");
+    static constexpr uint32_t m_all_fields = (1U << FIELD_COUNT) - 1;
 
     enum class RebootType : uint8_t {
         None,
@@ -43,10 +126,45 @@ class SettingsStore {
     };
 
     Storecache m_store_cache;
-    bool m_dirty{true};
+    uint32_t m_dirty_fields{m_all_fields};
     RebootType m_scheduled_reboot{RebootType::None};
 
-    Storecache read();
+    std::optional<uint32_t> m_active_sector;
+    uint32_t m_sequence{0};
+    uint32_t m_write_offset{0};
+    bool m_needs_compaction{false};
+
+    uint32_t m_erase_pending{0};
+    bool m_erase_check_pending{true};
+    uint32_t m_last_activity{0};
+    TimingStats m_erase_timing;
+    TimingStats m_program_timing;
+    uint32_t m_load_time_us{0};
+
+    void markDirty(Key key);
+    void markProfileDirty(Key key);
+    [[nodiscard]] Profile &activeProfile();
+    [[nodiscard]] const Profile &activeProfile() const;
+
+    static Storecache getDefaults();
+    void load(uint32_t sector);
+    bool loadLegacy();
+    void applyRecord(const RecordHeader &header, const uint8_t *value);
+    size_t serialize(uint32_t fields, std::span<uint8_t> buffer) const;
+
+    [[nodiscard]] static uint32_t getSectorOffset(uint32_t sector);
+    [[nodiscard]] static bool isErased(uint32_t offset, size_t length);
+    [[nodiscard]] static bool isSectorErased(uint32_t sector);
+    void updateErasePending();
+
+    template <typename TOperation> void runFlashOperation(TimingStats &timing, TOperation operation);
+    void program(uint32_t offset, std::span<const uint8_t> data);
+    void erase(uint32_t sector);
+
+    [[nodiscard]] uint32_t getNextSector() const;
+    [[nodiscard]] bool appendNeedsErase() const;
+    void append();
+    void compact();
 
   public:
     SettingsStore();
@@ -54,14 +172,14 @@ class SettingsStore {
     void setUsbMode(usb_mode_t mode);
     [[nodiscard]] usb_mode_t getUsbMode() const;
 
-    void setTriggerThresholds(const Peripherals::Drum::Config::Thresholds &thresholds);
-    [[nodiscard]] Peripherals::Drum::Config::Thresholds getTriggerThresholds() const;
+    void setTriggerThresholds(const Peripherals::DrumBase::Config::Thresholds &thresholds);
+    [[nodiscard]] Peripherals::DrumBase::Config::Thresholds getTriggerThresholds() const;
 
-    void setDoubleTriggerMode(const Peripherals::Drum::Config::DoubleTriggerMode &mode);
-    [[nodiscard]] Peripherals::Drum::Config::DoubleTriggerMode getDoubleTriggerMode() const;
+    void setDoubleTriggerMode(const Peripherals::DrumBase::Config::DoubleTriggerMode &mode);
+    [[nodiscard]] Peripherals::DrumBase::Config::DoubleTriggerMode getDoubleTriggerMode() const;
 
-    void setDoubleTriggerThresholds(const Peripherals::Drum::Config::Thresholds &thresholds);
-    [[nodiscard]] Peripherals::Drum::Config::Thresholds getDoubleTriggerThresholds() const;
+    void setDoubleTriggerThresholds(const Peripherals::DrumBase::Config::Thresholds &thresholds);
+    [[nodiscard]] Peripherals::DrumBase::Config::Thresholds getDoubleTriggerThresholds() const;
 
     void setLedBrightness(uint8_t brightness);
     [[nodiscard]] uint8_t getLedBrightness() const;
@@ -72,10 +190,31 @@ class SettingsStore {
     void setDebounceDelay(uint16_t delay);
     [[nodiscard]] uint16_t getDebounceDelay() const;
 
+    void setInputRemap(const InputRemap::Mapping &mapping);
+    [[nodiscard]] InputRemap::Mapping getInputRemap() const;
+
+    // Drum settings above refer to the active profile. Switching does not write to flash right away,
+    // the selection is persisted by update() during idle time or with the next store().
+    void setActiveProfile(uint8_t profile);
+    [[nodiscard]] uint8_t getActiveProfile() const;
+
     void scheduleReboot(bool bootsel = false);
 
+    // Writes pending changes and prepares the next journal sector, so that later writes from update() only need
+    // page programs. Meant for leaving the menu, where a stall of up to one sector erase does not matter.
     void store();
     void reset();
+
+    // Writes pending changes once no input happened for a while, unless that needs a sector erase while
+    // host_active. Stale journal sectors are erased only while the host is not active.
+    void update(bool input_active, bool host_active);
+
+    // Durations of all sector erases and page programs since boot, USB and core 1 are paused for each of them.
+    [[nodiscard]] const TimingStats &getEraseTiming() const { return m_erase_timing; };
+    [[nodiscard]] const TimingStats &getProgramTiming() const { return m_program_timing; };
+
+    // Time the constructor needed to find and parse the journal.
+    [[nodiscard]] uint32_t getLoadTime() const { return m_load_time_us; };
 };
 } // namespace Doncon::Utils
 
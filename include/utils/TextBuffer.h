@@ -0,0 +1,93 @@
+#ifndef UTILS_TEXTBUFFER_H_
+#define UTILS_TEXTBUFFER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Doncon::Utils {
+
+// Fixed size text formatter which never allocates, output exceeding the capacity is truncated.
+template <size_t TCapacity> class TextBuffer {
+  private:
+    std::array<char, TCapacity + 1> m_buffer{};
+    size_t m_length{0};
+
+  public:
+    TextBuffer() = default;
+
+    void clear() {
+        m_length = 0;
+        m_buffer[0] = '\0';
+    }
+
+    TextBuffer &append(const char c, const size_t count = 1) {
+        for (size_t i = 0; i < count && m_length < TCapacity; ++i) {
+            m_buffer[m_length++] = c;
+        }
+        m_buffer[m_length] = '\0';
+
+        return *this;
+    }
+
+    TextBuffer &append(const std::string_view str) {
+        for (const auto c : str) {
+            if (m_length >= TCapacity) {
+                break;
+            }
+            m_buffer[m_length++] = c;
+        }
+        m_buffer[m_length] = '\0';
+
+        return *this;
+    }
+
+    // Appends an unsigned decimal, right aligned to 'width' characters.
+    TextBuffer &append(uint32_t value, const size_t width = 0, const char pad = ' ') {
+        std::array<char, 10> digits{};
+        size_t count = 0;
+
+        do {
+            digits[count++] = static_cast<char>('0' + (value % 10));
+            value /= 10;
+        } while (value > 0);
+
+        if (width > count) {
+            append(pad, width - count);
+        }
+        while (count > 0) {
+            append(digits[--count]);
+        }
+
+        return *this;
+    }
+
+    // Appends a signed decimal, right aligned to 'width' characters.
+    TextBuffer &append(const int32_t value, const size_t width = 0) {
+        if (value >= 0) {
+            return append(static_cast<uint32_t>(value), width);
+        }
+
+        const auto magnitude = static_cast<uint32_t>(0) - static_cast<uint32_t>(value);
+        size_t digit_count = 1;
+        for (auto rest = magnitude / 10; rest > 0; rest /= 10) {
+            ++digit_count;
+        }
+        if (width > digit_count + 1) {
+            append(' ', width - digit_count - 1);
+        }
+
+        return append('-').append(magnitude);
+    }
+
+    [[nodiscard]] const char *c_str() const { return m_buffer.data(); }
+    [[nodiscard]] char *data() { return m_buffer.data(); }
+    [[nodiscard]] size_t size() const { return m_length; }
+    [[nodiscard]] bool empty() const { return m_length == 0; }
+    [[nodiscard]] std::string_view view() const { return {m_buffer.data(), m_length}; }
+};
+
+} // namespace Doncon::Utils
+
+#endif // UTILS_TEXTBUFFER_H_
\ No newline at end of file
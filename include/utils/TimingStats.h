@@ -0,0 +1,44 @@
+#ifndef UTILS_TIMINGSTATS_H_
+#define UTILS_TIMINGSTATS_H_
+
+#include "utils/TextBuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace Doncon::Utils {
+
+// Minimum, average and maximum of a recurring duration, e.g. a loop period in microseconds.
+struct TimingStats {
+    uint32_t min_us{std::numeric_limits<uint32_t>::max()};
+    uint32_t max_us{0};
+    uint32_t sum_us{0};
+    uint32_t count{0};
+
+    void record(const uint32_t duration_us) {
+        min_us = std::min(min_us, duration_us);
+        max_us = std::max(max_us, duration_us);
+        sum_us += duration_us;
+        count++;
+    }
+
+    void reset() { *this = {}; }
+
+    [[nodiscard]] uint32_t average() const { return count > 0 ? sum_us / count : 0; }
+
+    // Appends '<name> min/avg/max <min>/<avg>/<max>us'.
+    template <size_t TCapacity> void format(TextBuffer<TCapacity> &buffer, const std::string_view name) const {
+        buffer.append(name).append(" min/avg/max ");
+        if (count == 0) {
+            buffer.append("-/-/-");
+        } else {
+            buffer.append(min_us).append('/').append(average()).append('/').append(max_us);
+        }
+        buffer.append("us");
+    }
+};
+
+} // namespace Doncon::Utils
+
+#endif // UTILS_TIMINGSTATS_H_
\ No newline at end of file
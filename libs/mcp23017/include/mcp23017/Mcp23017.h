@@ -56,6 +56,11 @@ class Mcp23017 {
     void setReversePolarity(uint8_t pin, bool reverse);
     void setReversePolarity(uint8_t pin, Port port, bool reverse);
 
+    // Raise the INT pins on any change of the enabled inputs, compared to their previous value. Both INT pins are
+    // mirrored and open-drain, so one of them with a pull-up on the host side is sufficient. Reading the inputs
+    // clears the interrupt.
+    void setInterruptOnChange(uint16_t enable_mask);
+
     uint16_t read();
     uint8_t read(Port port);
     bool read(uint8_t pin);
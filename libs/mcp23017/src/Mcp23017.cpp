@@ -160,6 +160,13 @@ void Mcp23017::setReversePolarity(uint8_t pin, Port port, bool reverse) {
     }
 }
 
+void Mcp23017::setInterruptOnChange(uint16_t enable_mask) {
+    // MIRROR and ODR, keep sequential addressing
+    writeRegister8(Register::IOCON, 0x44);
+    writeRegister16(Register::INTCONA, 0x0000);
+    writeRegister16(Register::GPINTENA, enable_mask);
+}
+
 uint16_t Mcp23017::read() { return readRegister16(Register::GPIOA); }
 
 uint8_t Mcp23017::read(Port port) {
@@ -5,11 +5,27 @@
 #include "pico/time.h"
 
 #include <array>
+#include <span>
 
 class Mcp3204Dma {
+  public:
+    struct Sample {
+        uint32_t timestamp_us;
+        uint16_t value;
+        uint8_t channel;
+    };
+
+    struct IntervalStats {
+        uint32_t min_us;
+        uint32_t max_us;
+        uint32_t sum_us;
+        uint32_t count;
+    };
+
   private:
     static constexpr size_t CHANNEL_COUNT = 4;
     static constexpr size_t TRANSFER_LENGTH = 3;
+    static constexpr size_t CAPTURE_BUFFER_LENGTH = 1024; // Must be a power of two
 
     static int m_rx_channel;
     static int m_tx_channel;
@@ -21,10 +37,23 @@ class Mcp3204Dma {
     static std::array<uint16_t, CHANNEL_COUNT> m_current_max_readings;
 
     static uint8_t m_cs_pin;
+    static int m_alarm_num;
 
     static bool m_is_running;
 
-    static int64_t alarmHandler(alarm_id_t id, void *user_data);
+    // Single producer (DMA IRQ) / single consumer ring buffer of all raw samples.
+    static std::array<Sample, CAPTURE_BUFFER_LENGTH> m_capture_buffer;
+    static volatile size_t m_capture_head;
+    static volatile size_t m_capture_tail;
+    static volatile uint32_t m_capture_dropped;
+    static volatile bool m_capture_enabled;
+
+    // Time between two consecutive conversions, i.e. the sampling jitter.
+    static uint32_t m_last_sample_us;
+    static IntervalStats m_interval_stats;
+
+    static void alarmHandler();
+    static void startDmaRead();
     static void triggerDmaRead();
     static void dmaReadHandler();
 
@@ -37,6 +66,15 @@ class Mcp3204Dma {
     static void stop();
 
     static std::array<uint16_t, CHANNEL_COUNT> take_maximums();
+
+    static void set_capture_enabled(bool enabled);
+    static size_t take_samples(std::span<Sample> buffer);
+    static uint32_t get_dropped_samples();
+
+    static IntervalStats take_interval_stats();
+
+    // Interrupts used while sampling, 0 if not running.
+    static uint32_t get_irq_mask();
 };
 
 #endif // MCP3204_MCP3204DMA_H_
\ No newline at end of file
@@ -2,8 +2,18 @@
 
 #include "hardware/dma.h"
 #include "hardware/gpio.h"
+#include "hardware/timer.h"
 
 #include <algorithm>
+#include <limits>
+
+// The sampling loop runs entirely from interrupts, place it in SRAM if requested so it does not
+// depend on the XIP cache which is shared with everything else running from flash.
+#if MCP3204_DMA_IN_RAM
+#define MCP3204_RAM_FUNC(func_name) __not_in_flash_func(func_name)
+#else
+#define MCP3204_RAM_FUNC(func_name) func_name
+#endif
 
 int Mcp3204Dma::m_rx_channel = -1;
 int Mcp3204Dma::m_tx_channel = -1;
@@ -22,14 +32,22 @@ uint8_t Mcp3204Dma::m_current_channel = 0;
 std::array<uint16_t, Mcp3204Dma::CHANNEL_COUNT> Mcp3204Dma::m_current_max_readings = {};
 
 uint8_t Mcp3204Dma::m_cs_pin = UINT8_MAX;
+int Mcp3204Dma::m_alarm_num = -1;
 
 bool Mcp3204Dma::m_is_running = false;
 
-// Alarm handler to instantly (re)start DMA reading of the next channel.
-int64_t Mcp3204Dma::alarmHandler(alarm_id_t id, void *user_data) {
-    (void)user_data;
-    (void)id;
+std::array<Mcp3204Dma::Sample, Mcp3204Dma::CAPTURE_BUFFER_LENGTH> Mcp3204Dma::m_capture_buffer = {};
+volatile size_t Mcp3204Dma::m_capture_head = 0;
+volatile size_t Mcp3204Dma::m_capture_tail = 0;
+volatile uint32_t Mcp3204Dma::m_capture_dropped = 0;
+volatile bool Mcp3204Dma::m_capture_enabled = false;
 
+uint32_t Mcp3204Dma::m_last_sample_us = 0;
+Mcp3204Dma::IntervalStats Mcp3204Dma::m_interval_stats = {
+    .min_us = std::numeric_limits<uint32_t>::max(), .max_us = 0, .sum_us = 0, .count = 0};
+
+// Start DMA reading of the next channel.
+void MCP3204_RAM_FUNC(Mcp3204Dma::startDmaRead)() {
     // Reset addresses
     dma_channel_set_read_addr(m_tx_channel, m_tx_buffer.data(), false);
     dma_channel_set_write_addr(m_rx_channel, m_rx_buffer.data(), false);
@@ -37,25 +55,60 @@ int64_t Mcp3204Dma::alarmHandler(alarm_id_t id, void *user_data) {
     // Pull down CS pin and start both TX and RX at the same time
     gpio_put(m_cs_pin, false);
     dma_start_channel_mask((1 << m_tx_channel) | (1 << m_rx_channel));
+}
 
-    // Do not reschedule alarm
-    return 0;
+// Alarm handler to instantly (re)start DMA reading of the next channel.
+void MCP3204_RAM_FUNC(Mcp3204Dma::alarmHandler)() {
+    hw_clear_bits(&timer_hw->intr, 1U << m_alarm_num);
+
+    startDmaRead();
 }
 
-// Pull up CS pin and start DMA reading after a 1us delay, this is because MCP3204
+// Pull up CS pin and start DMA reading after a 2us delay, this is because MCP3204
 // needs to be the CS pin high for at least 500ns.
-void Mcp3204Dma::triggerDmaRead() {
+//
+// The hardware alarm is armed directly instead of using the SDK alarm pool, so no
+// code from flash is involved in the sampling loop.
+void MCP3204_RAM_FUNC(Mcp3204Dma::triggerDmaRead)() {
     gpio_put(m_cs_pin, true);
 
-    add_alarm_in_us(2, alarmHandler, nullptr, true);
+    const uint32_t alarm_mask = 1U << m_alarm_num;
+    const uint32_t target = timer_hw->timerawl + 2;
+    timer_hw->alarm[m_alarm_num] = target;
+
+    // Alarms only fire on an exact match, start right away if the target already passed while arming.
+    if (static_cast<int32_t>(timer_hw->timerawl - target) >= 0 && (timer_hw->armed & alarm_mask)) {
+        timer_hw->armed = alarm_mask;
+        startDmaRead();
+    }
 }
 
-void Mcp3204Dma::dmaReadHandler() {
+void MCP3204_RAM_FUNC(Mcp3204Dma::dmaReadHandler)() {
     // The 12 result bits are at the end of the ADC's output.
     const uint16_t value = (static_cast<uint16_t>(m_rx_buffer[1] & 0x0F) << 8) | m_rx_buffer[2];
 
+    const uint32_t now = time_us_32();
+    const uint32_t interval = now - m_last_sample_us;
+    m_last_sample_us = now;
+    m_interval_stats.min_us = std::min(m_interval_stats.min_us, interval);
+    m_interval_stats.max_us = std::max(m_interval_stats.max_us, interval);
+    m_interval_stats.sum_us += interval;
+    m_interval_stats.count++;
+
     // We only care for the maximum value since the last read
-    m_current_max_readings.at(m_current_channel) = std::max(m_current_max_readings.at(m_current_channel), value);
+    m_current_max_readings[m_current_channel] = std::max(m_current_max_readings[m_current_channel], value);
+
+    // Additionally record every single sample if requested
+    if (m_capture_enabled) {
+        const size_t next_head = (m_capture_head + 1) & (CAPTURE_BUFFER_LENGTH - 1);
+        if (next_head == m_capture_tail) {
+            m_capture_dropped = m_capture_dropped + 1;
+        } else {
+            m_capture_buffer[m_capture_head] = {
+                .timestamp_us = now, .value = value, .channel = m_current_channel};
+            m_capture_head = next_head;
+        }
+    }
 
     // Advance to the next channel
     m_current_channel = (m_current_channel + 1) % CHANNEL_COUNT;
@@ -90,6 +143,9 @@ void Mcp3204Dma::initialize(spi_inst *spi, uint8_t cs_pin) {
                           false);
 
     irq_set_exclusive_handler(DMA_IRQ_0, dmaReadHandler);
+
+    Mcp3204Dma::m_alarm_num = hardware_alarm_claim_unused(true);
+    irq_set_exclusive_handler(hardware_alarm_get_irq_num(m_alarm_num), alarmHandler);
 }
 
 void Mcp3204Dma::run(spi_inst *spi, uint8_t cs_pin) {
@@ -104,6 +160,10 @@ void Mcp3204Dma::run(spi_inst *spi, uint8_t cs_pin) {
     dma_channel_set_irq0_enabled(m_rx_channel, true);
     irq_set_enabled(DMA_IRQ_0, true);
 
+    hw_set_bits(&timer_hw->inte, 1U << m_alarm_num);
+    irq_set_enabled(hardware_alarm_get_irq_num(m_alarm_num), true);
+
+    m_last_sample_us = time_us_32();
     triggerDmaRead();
 }
 
@@ -115,6 +175,11 @@ void Mcp3204Dma::stop() {
     irq_set_enabled(DMA_IRQ_0, false);
     dma_channel_set_irq0_enabled(m_rx_channel, false);
 
+    irq_set_enabled(hardware_alarm_get_irq_num(m_alarm_num), false);
+    hw_clear_bits(&timer_hw->inte, 1U << m_alarm_num);
+    timer_hw->armed = 1U << m_alarm_num;
+    hardware_alarm_unclaim(m_alarm_num);
+
     dma_channel_wait_for_finish_blocking(m_rx_channel);
     dma_channel_wait_for_finish_blocking(m_tx_channel);
 
@@ -122,7 +187,7 @@ void Mcp3204Dma::stop() {
     dma_channel_unclaim(m_tx_channel);
 }
 
-std::array<uint16_t, Mcp3204Dma::CHANNEL_COUNT> Mcp3204Dma::take_maximums() {
+std::array<uint16_t, Mcp3204Dma::CHANNEL_COUNT> MCP3204_RAM_FUNC(Mcp3204Dma::take_maximums)() {
     // TODO: theoretically we should need to pause conversion for reading the values,
     //       but so far this does not seem to pose any issue.
     std::array<uint16_t, Mcp3204Dma::CHANNEL_COUNT> result{m_current_max_readings};
@@ -131,4 +196,43 @@ std::array<uint16_t, Mcp3204Dma::CHANNEL_COUNT> Mcp3204Dma::take_maximums() {
     std::ranges::fill(m_current_max_readings, 0);
 
     return result;
+}
+
+void Mcp3204Dma::set_capture_enabled(bool enabled) {
+    m_capture_tail = m_capture_head;
+    m_capture_enabled = enabled;
+}
+
+size_t Mcp3204Dma::take_samples(std::span<Sample> buffer) {
+    const size_t head = m_capture_head;
+    size_t tail = m_capture_tail;
+
+    size_t count = 0;
+    while (tail != head && count < buffer.size()) {
+        buffer[count++] = m_capture_buffer[tail];
+        tail = (tail + 1) & (CAPTURE_BUFFER_LENGTH - 1);
+    }
+
+    m_capture_tail = tail;
+
+    return count;
+}
+
+uint32_t Mcp3204Dma::get_dropped_samples() { return m_capture_dropped; }
+
+Mcp3204Dma::IntervalStats Mcp3204Dma::take_interval_stats() {
+    // Like take_maximums(), this might race with the DMA IRQ. Good enough for diagnostics.
+    const IntervalStats result{m_interval_stats};
+
+    m_interval_stats = {.min_us = std::numeric_limits<uint32_t>::max(), .max_us = 0, .sum_us = 0, .count = 0};
+
+    return result;
+}
+
+uint32_t Mcp3204Dma::get_irq_mask() {
+    if (!m_is_running) {
+        return 0;
+    }
+
+    return (1U << DMA_IRQ_0) | (1U << hardware_alarm_get_irq_num(m_alarm_num));
 }
\ No newline at end of file
@@ -37,6 +37,13 @@ SOFTWARE.
 extern "C" {
 #endif
 
+/**
+ *	@brief maximum number of data bytes per i2c transaction of ssd1306_show_async
+ */
+#ifndef SSD1306_CHUNK_SIZE
+#define SSD1306_CHUNK_SIZE 32
+#endif
+
 /**
  *	@brief defines commands used in ssd1306
  */
@@ -74,6 +81,11 @@ typedef struct {
     size_t bufsize;       /**< buffer size */
     int dma_channel;      /**< dma channel id for writing */
     uint16_t *dma_buffer; /**< buffer for dma transfer */
+    uint16_t dma_length;  /**< number of words prepared in dma_buffer */
+    uint16_t dma_offset;  /**< next word of dma_buffer to transfer */
+    uint8_t *sent_buffer; /**< display content after the last transfer */
+    bool full_refresh;    /**< whether the next transfer needs to send the whole buffer */
+    bool frame_aborted;   /**< whether the last transfer was dropped before it was complete */
 } ssd1306_t;
 
 /**
@@ -141,6 +153,71 @@ void ssd1306_invert(ssd1306_t *p, uint8_t inv);
 */
 void ssd1306_show(ssd1306_t *p);
 
+/**
+    @brief start sending the display buffer via DMA without blocking
+
+    Only pages whose content changed since the last transfer are sent, limited to the changed
+    column span. If nothing changed, no transfer is started at all.
+
+    The frame is split into i2c transactions of at most SSD1306_CHUNK_SIZE data bytes. Only the
+    first one is started, call ssd1306_show_continue() until it returns true to send the rest.
+    Other devices may use the bus whenever ssd1306_show_chunk_done() returns true.
+
+    The buffer is copied before the transfer starts, so it can be redrawn right away. Falls back
+    to ssd1306_show() if no DMA channel is available.
+
+    @param[in] p : instance of display
+
+    @return bool.
+    @retval true if the frame was prepared
+    @retval false if the previous frame is still being sent
+*/
+bool ssd1306_show_async(ssd1306_t *p);
+
+/**
+    @brief start the next chunk of the frame prepared by ssd1306_show_async() if the bus is free
+
+    @param[in] p : instance of display
+
+    @return bool.
+    @retval true if the whole frame has been sent
+*/
+bool ssd1306_show_continue(ssd1306_t *p);
+
+/**
+    @brief check whether the chunk currently being sent has finished
+
+    @param[in] p : instance of display
+
+    @return bool.
+    @retval true if the i2c bus is idle
+*/
+bool ssd1306_show_chunk_done(ssd1306_t *p);
+
+/**
+    @brief check whether the frame prepared by ssd1306_show_async() has been sent completely
+
+    @param[in] p : instance of display
+
+    @return bool.
+    @retval true if all chunks have been sent and the i2c bus is idle
+*/
+bool ssd1306_show_done(ssd1306_t *p);
+
+/**
+    @brief check whether the last frame was dropped before it was sent completely
+
+    A NACK aborts the transfer of the current frame, the display keeps showing a partial frame.
+    The frame is not resent by itself, the next ssd1306_show_async() sends the whole buffer and
+    clears this flag.
+
+    @param[in] p : instance of display
+
+    @return bool.
+    @retval true if a frame was aborted since the last call to ssd1306_show_async()
+*/
+bool ssd1306_show_aborted(const ssd1306_t *p);
+
 /**
     @brief clear display buffer
 
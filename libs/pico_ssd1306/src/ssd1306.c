@@ -23,6 +23,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <hardware/dma.h>
 #include <hardware/i2c.h>
 #include <pico/binary_info.h>
 #include <pico/stdlib.h>
@@ -33,6 +34,9 @@ SOFTWARE.
 #include "font.h"
 #include "ssd1306.h"
 
+// Address commands preceding each changed page span
+#define SSD1306_SHOW_CMD_COUNT 6
+
 inline static void swap(int32_t *a, int32_t *b) {
     int32_t *t = a;
     *a = *b;
@@ -74,6 +78,35 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
 
     ++(p->buffer);
 
+    // Each word holds a data byte plus the STOP flag for IC_DATA_CMD. For each changed page span there is a
+    // transaction with the address commands, followed by the span data split into chunk sized transactions.
+    p->frame_aborted = false;
+    p->dma_channel = dma_claim_unused_channel(false);
+    if (p->dma_channel >= 0) {
+        const size_t chunks_per_page = (p->width + SSD1306_CHUNK_SIZE - 1) / SSD1306_CHUNK_SIZE;
+        p->dma_buffer = malloc(((SSD1306_SHOW_CMD_COUNT + 1 + chunks_per_page) * p->pages + p->bufsize) *
+                               sizeof(uint16_t));
+        p->dma_length = 0;
+        p->dma_offset = 0;
+        p->sent_buffer = malloc(p->bufsize);
+        p->full_refresh = true;
+
+        if (p->dma_buffer == NULL || p->sent_buffer == NULL) {
+            free(p->dma_buffer);
+            free(p->sent_buffer);
+            dma_channel_unclaim(p->dma_channel);
+            p->dma_channel = -1;
+        } else {
+            dma_channel_config config = dma_channel_get_default_config(p->dma_channel);
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+            channel_config_set_read_increment(&config, true);
+            channel_config_set_write_increment(&config, false);
+            channel_config_set_dreq(&config, i2c_get_dreq(p->i2c_i, true));
+            dma_channel_configure(p->dma_channel, &config, &i2c_get_hw(p->i2c_i)->data_cmd, p->dma_buffer, 0,
+                                  false);
+        }
+    }
+
     // from https://github.com/makerportal/rpi-pico-ssd1306
     uint8_t cmds[] = {
         SET_DISP,
@@ -103,7 +136,15 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
     return true;
 }
 
-inline void ssd1306_deinit(ssd1306_t *p) { free(p->buffer - 1); }
+void ssd1306_deinit(ssd1306_t *p) {
+    if (p->dma_channel >= 0) {
+        dma_channel_abort(p->dma_channel);
+        dma_channel_unclaim(p->dma_channel);
+        free(p->dma_buffer);
+        free(p->sent_buffer);
+    }
+    free(p->buffer - 1);
+}
 
 inline void ssd1306_poweroff(ssd1306_t *p) { ssd1306_write(p, SET_DISP | 0x00); }
 
@@ -267,16 +308,135 @@ inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long
 }
 
 void ssd1306_show(ssd1306_t *p) {
-    uint8_t payload[] = {SET_COL_ADDR, 0, p->width - 1, SET_PAGE_ADDR, 0, p->pages - 1};
+    uint8_t payload[] = {0x00, SET_COL_ADDR, 0, p->width - 1, SET_PAGE_ADDR, 0, p->pages - 1};
     if (p->width == 64) {
-        payload[1] += 32;
         payload[2] += 32;
+        payload[3] += 32;
     }
 
-    for (size_t i = 0; i < sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
+    fancy_write(p->i2c_i, p->address, payload, sizeof(payload), "ssd1306_show");
 
     *(p->buffer - 1) = 0x40;
 
     fancy_write(p->i2c_i, p->address, p->buffer - 1, p->bufsize + 1, "ssd1306_show");
-}
\ No newline at end of file
+
+    if (p->dma_channel >= 0) {
+        memcpy(p->sent_buffer, p->buffer, p->bufsize);
+        p->full_refresh = false;
+    }
+}
+
+bool ssd1306_show_async(ssd1306_t *p) {
+    if (p->dma_channel < 0) {
+        ssd1306_show(p);
+        return true;
+    }
+
+    if (!ssd1306_show_done(p)) {
+        return false;
+    }
+
+    const uint8_t col_offset = p->width == 64 ? 32 : 0;
+
+    // Only the changed column span of each page is sent. Every transaction ends with a stop, so the bus is free
+    // for other devices between any two chunks.
+    uint16_t *word = p->dma_buffer;
+    for (uint8_t page = 0; page < p->pages; ++page) {
+        const uint8_t *current = p->buffer + page * p->width;
+        uint8_t *sent = p->sent_buffer + page * p->width;
+
+        uint8_t first = 0;
+        uint8_t last = p->width - 1;
+        if (!p->full_refresh) {
+            while (first < p->width && current[first] == sent[first])
+                ++first;
+            if (first == p->width)
+                continue;
+            while (current[last] == sent[last])
+                --last;
+        }
+
+        const uint8_t cmds[SSD1306_SHOW_CMD_COUNT] = {
+            SET_COL_ADDR, col_offset + first, col_offset + last, SET_PAGE_ADDR, page, page,
+        };
+
+        *word++ = 0x00;
+        for (size_t i = 0; i < sizeof(cmds); ++i)
+            *word++ = cmds[i];
+        *(word - 1) |= I2C_IC_DATA_CMD_STOP_BITS;
+
+        // The display keeps its address pointer between transactions, each chunk just continues the span.
+        for (uint8_t col = first; col <= last; ++col) {
+            if ((col - first) % SSD1306_CHUNK_SIZE == 0)
+                *word++ = 0x40;
+            *word++ = current[col];
+            if ((col - first) % SSD1306_CHUNK_SIZE == SSD1306_CHUNK_SIZE - 1 || col == last)
+                *(word - 1) |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+
+        memcpy(sent + first, current + first, last - first + 1);
+    }
+
+    p->full_refresh = false;
+    p->frame_aborted = false;
+    p->dma_length = (uint16_t)(word - p->dma_buffer);
+    p->dma_offset = 0;
+
+    ssd1306_show_continue(p);
+
+    return true;
+}
+
+bool ssd1306_show_chunk_done(ssd1306_t *p) {
+    if (p->dma_channel < 0) {
+        return true;
+    }
+
+    if (dma_channel_is_busy(p->dma_channel)) {
+        return false;
+    }
+
+    i2c_hw_t *hw = i2c_get_hw(p->i2c_i);
+
+    // On a NACK the controller flushes its FIFO and discards all further DMA writes until cleared. The
+    // display content is unknown afterwards, so the rest of the frame is dropped and the next one is sent
+    // completely.
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt;
+        p->dma_offset = p->dma_length;
+        p->full_refresh = true;
+        p->frame_aborted = true;
+        return true;
+    }
+
+    return (hw->status & I2C_IC_STATUS_TFE_BITS) && !(hw->status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+bool ssd1306_show_continue(ssd1306_t *p) {
+    if (!ssd1306_show_chunk_done(p)) {
+        return false;
+    }
+
+    if (p->dma_offset >= p->dma_length) {
+        return true;
+    }
+
+    uint16_t end = p->dma_offset;
+    while (!(p->dma_buffer[end++] & I2C_IC_DATA_CMD_STOP_BITS))
+        ;
+
+    // Other devices on the bus may have changed the target address in the meantime
+    i2c_hw_t *hw = i2c_get_hw(p->i2c_i);
+    hw->enable = 0;
+    hw->tar = p->address;
+    hw->enable = 1;
+
+    dma_channel_transfer_from_buffer_now(p->dma_channel, p->dma_buffer + p->dma_offset, end - p->dma_offset);
+    p->dma_offset = end;
+
+    return false;
+}
+
+bool ssd1306_show_done(ssd1306_t *p) { return ssd1306_show_chunk_done(p) && p->dma_offset >= p->dma_length; }
+
+bool ssd1306_show_aborted(const ssd1306_t *p) { return p->frame_aborted; }
\ No newline at end of file
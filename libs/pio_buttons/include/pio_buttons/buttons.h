@@ -0,0 +1,27 @@
+#ifndef PIO_BUTTONS_BUTTONS_H_
+#define PIO_BUTTONS_BUTTONS_H_
+
+#include "hardware/pio.h"
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Samples the pin_count button pins starting at pin_base every 5us with a PIO state machine, independent of the
+// CPU. Only those pins are read, so activity on other pins causes no work at all. Changes are debounced per pin in
+// the RX FIFO interrupt, which is handled on the calling core: a pin follows its first edge right away and then
+// ignores further edges for lock_us microseconds. Only one instance is supported.
+void buttons_init(PIO pio, uint pin_base, uint pin_count, uint32_t lock_us);
+
+// Returns the debounced raw pin state, bit 0 being pin_base.
+uint32_t buttons_get_state(void);
+
+// Returns the number of state changes reported by the state machine since the last call.
+uint32_t buttons_take_event_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIO_BUTTONS_BUTTONS_H_
\ No newline at end of file
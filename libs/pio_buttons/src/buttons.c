@@ -0,0 +1,94 @@
+#include "buttons.h"
+#include "buttons.pio.h"
+
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include <string.h>
+
+// State machine clock, one sample takes 5us.
+#define BUTTONS_SM_FREQ 1000000
+
+static PIO buttons_pio;
+static uint buttons_sm;
+static uint32_t buttons_lock_us;
+
+static uint32_t raw_state = 0;
+static uint32_t debounced_state = 0;
+static uint32_t locked_pins = 0;
+static uint32_t lock_start_us[32];
+static uint32_t event_count = 0;
+
+// Unlocks pins whose lock time expired, then lets all unlocked pins follow the raw state. Pins which change are
+// locked, so each pin follows its first edge right away and ignores its own contact bounce afterwards.
+static void update_debounced(uint32_t now_us) {
+    uint32_t locked = locked_pins;
+    for (uint32_t remaining = locked; remaining != 0; remaining &= remaining - 1) {
+        const uint pin = (uint)__builtin_ctz(remaining);
+        if (now_us - lock_start_us[pin] >= buttons_lock_us) {
+            locked &= ~(1U << pin);
+        }
+    }
+
+    const uint32_t changed = (raw_state ^ debounced_state) & ~locked;
+    for (uint32_t remaining = changed; remaining != 0; remaining &= remaining - 1) {
+        lock_start_us[__builtin_ctz(remaining)] = now_us;
+    }
+
+    debounced_state ^= changed;
+    locked_pins = locked | changed;
+}
+
+static void buttons_irq_handler(void) {
+    const uint32_t now_us = time_us_32();
+
+    while (!pio_sm_is_rx_fifo_empty(buttons_pio, buttons_sm)) {
+        raw_state = pio_sm_get(buttons_pio, buttons_sm);
+        event_count++;
+        update_debounced(now_us);
+    }
+}
+
+void buttons_init(PIO pio, uint pin_base, uint pin_count, uint32_t lock_us) {
+    buttons_pio = pio;
+    buttons_lock_us = lock_us;
+    buttons_sm = (uint)pio_claim_unused_sm(pio, true);
+
+    uint16_t instructions[count_of(buttons_program_instructions)];
+    memcpy(instructions, buttons_program_instructions, sizeof(instructions));
+    instructions[buttons_offset_sample_pins] = (uint16_t)pio_encode_in(pio_pins, pin_count);
+
+    pio_program_t program = buttons_program;
+    program.instructions = instructions;
+    const uint offset = pio_add_program(pio, &program);
+
+    // Drain the FIFO on every push, so the state is always current and the state machine never waits.
+    const uint irq_num = pio_get_irq_num(pio, 0);
+    pio_set_irqn_source_enabled(pio, 0, pio_get_rx_fifo_not_empty_interrupt_source(buttons_sm), true);
+    irq_add_shared_handler(irq_num, buttons_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(irq_num, true);
+
+    buttons_program_init(pio, buttons_sm, offset, pin_base, BUTTONS_SM_FREQ);
+}
+
+uint32_t buttons_get_state(void) {
+    const uint32_t status = save_and_disable_interrupts();
+
+    update_debounced(time_us_32());
+    const uint32_t state = debounced_state;
+
+    restore_interrupts(status);
+
+    return state;
+}
+
+uint32_t buttons_take_event_count(void) {
+    const uint32_t status = save_and_disable_interrupts();
+
+    const uint32_t count = event_count;
+    event_count = 0;
+
+    restore_interrupts(status);
+
+    return count;
+}
\ No newline at end of file
@@ -13,9 +13,23 @@ void ws2812_init(PIO pio, uint8_t pin, bool is_rgbw);
 uint32_t ws2812_rgb_to_u32pixel(uint8_t r, uint8_t g, uint8_t b);
 uint32_t ws2812_rgb_to_gamma_corrected_u32pixel(uint8_t r, uint8_t g, uint8_t b);
 
+// Prepares non-blocking frame output via DMA for strips of up to max_length pixels.
+bool ws2812_init_dma(PIO pio, size_t max_length);
+// Whether frames are sent via DMA, otherwise ws2812_put_frame_async() blocks and sleeps until the frame is sent.
+bool ws2812_has_dma(void);
+
+// Fills lut with the gamma corrected value of each channel value at the given brightness.
+void ws2812_build_brightness_lut(uint8_t brightness, uint8_t lut[256]);
+
 void ws2812_put_pixel(PIO pio, uint32_t pixel_grb);
 void ws2812_put_frame(PIO pio, uint32_t *frame, size_t length);
 
+// Starts sending a frame via DMA and returns immediately, frame is copied and can be reused right away.
+// Returns false without sending if the previous frame has not been sent and latched yet. Falls back to
+// ws2812_put_frame() if ws2812_init_dma() failed or has not been called.
+bool ws2812_put_frame_async(PIO pio, const uint32_t *frame, size_t length);
+bool ws2812_frame_done(PIO pio);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,19 @@
 #include "ws2812.pio.h"
 
 #include "hardware/clocks.h"
+#include "hardware/dma.h"
+
+#include <stdlib.h>
+
+// Time the data line needs to stay low after the last pixel to latch a frame, includes shifting out the
+// last pixel after the FIFO ran empty.
+#define WS2812_LATCH_US 300
+
+static int dma_channel = -1;
+static uint32_t *dma_buffer = NULL;
+static size_t dma_buffer_length = 0;
+static bool latch_pending = false;
+static absolute_time_t latch_time;
 
 static const uint8_t gamma_correct[] = {
     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
@@ -38,6 +51,37 @@ uint32_t ws2812_rgb_to_gamma_corrected_u32pixel(uint8_t r, uint8_t g, uint8_t b)
     return ((uint32_t)(gamma_correct[r]) << 8) | ((uint32_t)(gamma_correct[g]) << 16) | (uint32_t)(gamma_correct[b]);
 }
 
+bool ws2812_init_dma(PIO pio, size_t max_length) {
+    dma_channel = dma_claim_unused_channel(false);
+    if (dma_channel < 0) {
+        return false;
+    }
+
+    if ((dma_buffer = malloc(max_length * sizeof(uint32_t))) == NULL) {
+        dma_channel_unclaim(dma_channel);
+        dma_channel = -1;
+        return false;
+    }
+    dma_buffer_length = max_length;
+
+    dma_channel_config config = dma_channel_get_default_config(dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, 0, true));
+    dma_channel_configure(dma_channel, &config, &pio->txf[0], dma_buffer, 0, false);
+
+    return true;
+}
+
+bool ws2812_has_dma(void) { return dma_channel >= 0; }
+
+void ws2812_build_brightness_lut(uint8_t brightness, uint8_t lut[256]) {
+    for (uint32_t value = 0; value < 256; ++value) {
+        lut[value] = gamma_correct[(value * brightness) / UINT8_MAX];
+    }
+}
+
 void ws2812_put_pixel(PIO pio, uint32_t pixel_grb) { pio_sm_put_blocking(pio, 0, pixel_grb << 8U); }
 
 void ws2812_put_frame(PIO pio, uint32_t *frame, size_t length) {
@@ -50,3 +94,43 @@ void ws2812_put_frame(PIO pio, uint32_t *frame, size_t length) {
         ws2812_put_pixel(pio, frame[i]);
     }
 }
+
+bool ws2812_frame_done(PIO pio) {
+    if (dma_channel < 0) {
+        return true;
+    }
+
+    if (dma_channel_is_busy(dma_channel) || !pio_sm_is_tx_fifo_empty(pio, 0)) {
+        return false;
+    }
+
+    if (latch_pending) {
+        latch_time = make_timeout_time_us(WS2812_LATCH_US);
+        latch_pending = false;
+    }
+
+    return time_reached(latch_time);
+}
+
+bool ws2812_put_frame_async(PIO pio, const uint32_t *frame, size_t length) {
+    if (dma_channel < 0) {
+        ws2812_put_frame(pio, (uint32_t *)frame, length);
+        return true;
+    }
+
+    if (!ws2812_frame_done(pio)) {
+        return false;
+    }
+
+    if (length > dma_buffer_length) {
+        length = dma_buffer_length;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        dma_buffer[i] = frame[i] << 8U;
+    }
+
+    dma_channel_transfer_from_buffer_now(dma_channel, dma_buffer, length);
+    latch_pending = true;
+
+    return true;
+}
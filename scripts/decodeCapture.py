@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+
+"""Decode raw ADC capture frames streamed by the controller in 'Capture' mode.
+
+Reads from a serial port (requires pyserial) or a previously recorded binary file
+and writes either a CSV file with one line per sample or a multichannel WAV file.
+
+Examples:
+    decodeCapture.py /dev/ttyACM0 capture.csv --duration 10
+    decodeCapture.py capture.bin capture.wav --rate 20000
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import wave
+
+SYNC_WORD = 0xCA9E
+HEADER = struct.Struct("<HHIHBB")
+SAMPLE = struct.Struct("<HH")
+CHANNEL_COUNT = 4
+
+
+class Stats:
+    def __init__(self):
+        self.frames = 0
+        self.samples = 0
+        self.dropped_samples = 0
+        self.lost_frames = 0
+        self.bad_frames = 0
+
+
+def open_source(path):
+    if os.path.exists(path) and not path.startswith("/dev/"):
+        return open(path, "rb")
+
+    try:
+        import serial
+    except ImportError:
+        raise Exception("Reading from a serial port requires pyserial.")
+
+    return serial.Serial(path, timeout=0.1)
+
+
+def read_frames(source, stats, duration, raw_out):
+    """Yields (timestamp_us, channel, value) for every sample in every valid frame."""
+    buffer = bytearray()
+    last_sequence = None
+    start = time.monotonic()
+
+    while duration is None or time.monotonic() - start < duration:
+        chunk = source.read(4096)
+        if not chunk:
+            if hasattr(source, "in_waiting"):
+                continue
+            break
+
+        if raw_out:
+            raw_out.write(chunk)
+        buffer.extend(chunk)
+
+        while True:
+            sync_pos = buffer.find(struct.pack("<H", SYNC_WORD))
+            if sync_pos < 0:
+                del buffer[:-1]
+                break
+            del buffer[:sync_pos]
+
+            if len(buffer) < HEADER.size:
+                break
+
+            _, sequence, timestamp_us, dropped, count, checksum = HEADER.unpack_from(buffer)
+            frame_size = HEADER.size + count * SAMPLE.size
+            if len(buffer) < frame_size:
+                break
+
+            frame = bytearray(buffer[:frame_size])
+            frame[HEADER.size - 1] = 0
+            if (sum(frame) & 0xFF) != checksum or count == 0:
+                # Not an actual frame start, skip sync word and search again
+                stats.bad_frames += 1
+                del buffer[:2]
+                continue
+
+            if last_sequence is not None:
+                stats.lost_frames += (sequence - last_sequence - 1) & 0xFFFF
+            last_sequence = sequence
+
+            stats.frames += 1
+            stats.samples += count
+            stats.dropped_samples += dropped
+
+            for idx in range(count):
+                offset_us, packed = SAMPLE.unpack_from(buffer, HEADER.size + idx * SAMPLE.size)
+                yield (timestamp_us + offset_us) & 0xFFFFFFFF, packed >> 14, packed & 0x0FFF
+
+            del buffer[:frame_size]
+
+
+def unwrap_timestamps(samples):
+    """Turns the wrapping 32bit timestamps into a monotonic microsecond count starting at zero."""
+    first = None
+    previous = None
+    offset = 0
+
+    for timestamp, channel, value in samples:
+        if first is None:
+            first = timestamp
+        if previous is not None and timestamp < previous:
+            offset += 1 << 32
+        previous = timestamp
+
+        yield timestamp + offset - first, channel, value
+
+
+def write_csv(samples, path):
+    with open(path, "w") as csv_file:
+        csv_file.write("timestamp_us,channel,value\n")
+        for timestamp, channel, value in samples:
+            csv_file.write("{},{},{}\n".format(timestamp, channel, value))
+
+
+def write_wav(samples, path, rate):
+    """Resamples all channels to a fixed rate using sample-and-hold and writes a 16bit WAV file."""
+    period_us = 1000000 / rate
+    current = [0] * CHANNEL_COUNT
+    next_tick_us = 0.0
+
+    with wave.open(path, "wb") as wav_file:
+        wav_file.setnchannels(CHANNEL_COUNT)
+        wav_file.setsampwidth(2)
+        wav_file.setframerate(rate)
+
+        frames = bytearray()
+        for timestamp, channel, value in samples:
+            while timestamp >= next_tick_us:
+                # Scale 12bit unsigned to 16bit signed
+                frames.extend(struct.pack("<4h", *[(v << 4) - 0x8000 for v in current]))
+                next_tick_us += period_us
+            current[channel] = value
+
+            if len(frames) > 1 << 16:
+                wav_file.writeframes(frames)
+                frames = bytearray()
+
+        wav_file.writeframes(frames)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode DonCon2040 raw ADC capture streams.")
+    parser.add_argument("source", help="serial port or recorded binary file")
+    parser.add_argument("output", help="output file, format chosen by extension (.csv or .wav)")
+    parser.add_argument("--rate", type=int, default=10000, help="WAV sample rate per channel in Hz")
+    parser.add_argument("--duration", type=float, help="seconds to record when reading from a serial port")
+    parser.add_argument("--raw", help="additionally store the undecoded stream to this file")
+    args = parser.parse_args()
+
+    stats = Stats()
+    raw_out = open(args.raw, "wb") if args.raw else None
+
+    with open_source(args.source) as source:
+        samples = unwrap_timestamps(read_frames(source, stats, args.duration, raw_out))
+
+        if args.output.lower().endswith(".wav"):
+            write_wav(samples, args.output, args.rate)
+        elif args.output.lower().endswith(".csv"):
+            write_csv(samples, args.output)
+        else:
+            raise Exception("Unknown output format, use .csv or .wav")
+
+    if raw_out:
+        raw_out.close()
+
+    print(
+        "{} frames, {} samples, {} samples dropped on device, {} frames lost, {} invalid frames".format(
+            stats.frames, stats.samples, stats.dropped_samples, stats.lost_frames, stats.bad_frames
+        ),
+        file=sys.stderr,
+    )
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,24 +1,33 @@
 #include "peripherals/Controller.h"
 #include "peripherals/Display.h"
 #include "peripherals/Drum.h"
+#include "peripherals/I2cBus.h"
 #include "peripherals/StatusLed.h"
 #include "usb/device/hid/ps4_auth.h"
 #include "usb/device_driver.h"
+#include "utils/CaptureReport.h"
+#include "utils/DrumScope.h"
 #include "utils/InputReport.h"
 #include "utils/InputState.h"
 #include "utils/Menu.h"
 #include "utils/PS4AuthProvider.h"
 #include "utils/SettingsStore.h"
+#include "utils/TextBuffer.h"
+#include "utils/TimingStats.h"
 
 #include "GlobalConfiguration.h"
 #include "PS4AuthConfiguration.h"
 
+#include "hardware/irq.h"
+#include "hardware/timer.h"
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
 #include "pico/time.h"
 #include "pico/util/queue.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <iterator>
 
 using namespace Doncon;
 
@@ -32,8 +41,32 @@ queue_t controller_input_queue;
 queue_t auth_challenge_queue;
 queue_t auth_signed_challenge_queue;
 
+queue_t core1_stats_queue;
+
+// Filled on core 0 and drained by the display on core 1, never blocks the sampling.
+Utils::DrumScope drum_scope;
+
+// Core 1 signs PS4 challenges with mbedtls and runs serviceIo() from a timer interrupt on top of that, the SDK
+// default of 2KB is too small. The stack is prefilled to report the deepest use in the debug output.
+constexpr uint32_t core1_stack_fill = 0xC0DEC0DE;
+std::array<uint32_t, 8 * 1024 / sizeof(uint32_t)> core1_stack;
+
+uint32_t core1_stack_used() {
+    const auto untouched =
+        std::ranges::find_if(core1_stack, [](const uint32_t word) { return word != core1_stack_fill; });
+    return static_cast<uint32_t>(std::distance(untouched, core1_stack.end()) * sizeof(uint32_t));
+}
+
+// PS4 challenge to sign or the resulting signature, tagged with the sign request of ps4_auth it belongs to.
+struct AuthMessage {
+    uint32_t request;
+    std::array<uint8_t, Utils::PS4AuthProvider::SIGNATURE_LENGTH> data;
+};
+
 enum class ControlCommand : uint8_t {
     SetUsbMode,
+    SetProfile,
+    SetTriggerThresholds,
     SetPlayerLed,
     SetLedBrightness,
     SetLedEnablePlayerColor,
@@ -41,10 +74,24 @@ enum class ControlCommand : uint8_t {
     ExitMenu,
 };
 
+// Button read, LED and display frame, IO and signing statistics of core 1, see reportTiming() on core 0.
+struct Core1Stats {
+    Utils::TimingStats read_latency;
+    Peripherals::GpioStats gpio;
+    Utils::TimingStats led_frame;
+    Utils::TimingStats display_frame;
+    Utils::TimingStats io_interval;
+    Utils::TimingStats auth_sign;
+    uint32_t stack_used;
+    uint32_t interval_ms;
+};
+
 struct ControlMessage {
     ControlCommand command;
     union {
         usb_mode_t usb_mode;
+        uint8_t profile;
+        Peripherals::DrumBase::Config::Thresholds trigger_thresholds;
         usb_player_led_t player_led;
         uint8_t led_brightness;
         bool led_enable_player_color;
@@ -62,28 +109,88 @@ void core1_task() {
     gpio_pull_up(Config::Default::i2c_config.scl_pin);
     i2c_init(Config::Default::i2c_config.block, Config::Default::i2c_config.speed_hz);
 
-    Peripherals::Controller controller(Config::Default::controller_config);
+    Peripherals::Controller<Config::Default::ControllerGpio> controller(Config::Default::controller_config,
+                                                                  Config::Default::controller_gpio_config);
     Peripherals::StatusLed led(Config::Default::led_config);
     Peripherals::Display display(Config::Default::display_config);
+    Peripherals::I2cBus<Peripherals::Display> i2c_bus(display);
 
     Utils::PS4AuthProvider ps4authprovider;
-    std::array<uint8_t, Utils::PS4AuthProvider::SIGNATURE_LENGTH> auth_challenge{};
+    AuthMessage auth_challenge{};
 
     Utils::InputState input_state;
     Utils::Menu::State menu_display_msg{};
     ControlMessage control_msg{};
 
-    while (true) {
-        controller.updateInputState(input_state);
+    // Holding Select and pressing Left or Right cycles through the views of the idle screen.
+    const auto checkIdleViewHotkey = [&input_state]() -> int {
+        static uint32_t previous_buttons = 0;
+
+        const uint32_t pressed = input_state.controller.buttons & ~previous_buttons;
+        previous_buttons = input_state.controller.buttons;
+
+        if (!input_state.controller.isPressed(Utils::InputState::Input::Select)) {
+            return 0;
+        }
+        if (pressed & Utils::InputState::bit(Utils::InputState::Input::Left)) {
+            return -1;
+        }
+        if (pressed & Utils::InputState::bit(Utils::InputState::Input::Right)) {
+            return 1;
+        }
+        return 0;
+    };
+
+    // Button, LED and display statistics, published roughly once per second for the debug output on core 0.
+    static const uint32_t stats_publish_interval_ms = 1000;
+    uint32_t stats_published = 0;
+
+    // Time between two runs of serviceIo() and the duration of signing PS4 challenges.
+    Utils::TimingStats io_intervals;
+    Utils::TimingStats auth_sign_time;
+    uint32_t io_last_us = time_us_32();
+
+    // Everything core 1 does apart from signing PS4 challenges. from_timer is set while running in the timer
+    // interrupt during signing, nothing called from there may sleep.
+    auto serviceIo = [&](const bool from_timer) {
+        const uint32_t io_start_us = time_us_32();
+        io_intervals.record(io_start_us - io_last_us);
+        io_last_us = io_start_us;
+
+        // The display shares the I2C bus, button reads go first and only wait for the chunk currently sent.
+        // Updates without a pending read just reapply debouncing to the last state and don't touch the bus.
+        if (Config::Default::ControllerGpio::uses_i2c && controller.isReadPending()) {
+            i2c_bus.runForeground([&]() { controller.updateInputState(input_state); });
+        } else {
+            controller.updateInputState(input_state);
+        }
 
         queue_try_add(&controller_input_queue, &input_state.controller);
         queue_try_remove(&drum_input_queue, &input_state.drum);
 
+        Utils::DrumScope::Sample scope_sample{};
+        while (drum_scope.take(scope_sample)) {
+            display.addScopeSample(scope_sample);
+        }
+
+        if (const auto step = checkIdleViewHotkey(); step != 0) {
+            using IdleView = Peripherals::Display::IdleView;
+            const auto count = static_cast<int>(IdleView::Timeline) + 1;
+            display.setIdleView(
+                static_cast<IdleView>((static_cast<int>(display.getIdleView()) + count + step) % count));
+        }
+
         if (queue_try_remove(&control_queue, &control_msg)) {
             switch (control_msg.command) {
             case ControlCommand::SetUsbMode:
                 display.setUsbMode(control_msg.data.usb_mode);
                 break;
+            case ControlCommand::SetProfile:
+                display.setProfile(control_msg.data.profile);
+                break;
+            case ControlCommand::SetTriggerThresholds:
+                display.setTriggerThresholds(control_msg.data.trigger_thresholds);
+                break;
             case ControlCommand::SetPlayerLed:
                 switch (control_msg.data.player_led.type) {
                 case USB_PLAYER_LED_ID:
@@ -112,17 +219,73 @@ void core1_task() {
         if (queue_try_remove(&menu_display_queue, &menu_display_msg)) {
             display.setMenuState(menu_display_msg);
         }
-        if (queue_try_remove(&auth_challenge_queue, auth_challenge.data())) {
-            const auto signed_challenge = ps4authprovider.sign(auth_challenge);
-            queue_try_remove(&auth_signed_challenge_queue, nullptr); // clear queue first
-            queue_try_add(&auth_signed_challenge_queue, &signed_challenge);
-        }
 
         led.setInputState(input_state);
         display.setInputState(input_state);
 
-        led.update();
+        // Without DMA the LED strip is written while sleeping in between, it stays as is until signing is done.
+        if (!from_timer || led.isNonBlocking()) {
+            led.update();
+        }
         display.update();
+        i2c_bus.runBackground();
+
+        if (const uint32_t now = to_ms_since_boot(get_absolute_time());
+            (now - stats_published) >= stats_publish_interval_ms) {
+            const Core1Stats stats = {.read_latency = i2c_bus.takeForegroundLatency(),
+                                      .gpio = controller.takeGpioStats(),
+                                      .led_frame = led.takeFrameTime(),
+                                      .display_frame = display.takeRenderTime(),
+                                      .io_interval = io_intervals,
+                                      .auth_sign = auth_sign_time,
+                                      .stack_used = core1_stack_used(),
+                                      .interval_ms = now - stats_published};
+            queue_try_remove(&core1_stats_queue, nullptr); // drop stale stats if not consumed
+            queue_try_add(&core1_stats_queue, &stats);
+            stats_published = now;
+
+            io_intervals.reset();
+            auth_sign_time.reset();
+        }
+    };
+
+    // Signing takes a few seconds. Meanwhile IO is serviced from a timer interrupt on this core so buttons, LED and
+    // display keep working, the big number math only runs in between. serviceIo() must therefore not allocate, the
+    // interrupt might preempt mbedtls within malloc(). The timer runs at the lowest priority, so the flash lockout
+    // requested by core 0 does not have to wait until serviceIo() is done.
+    static const int64_t sign_io_interval_us = 1000;
+    alarm_pool_t *io_alarm_pool = alarm_pool_create_with_unused_hardware_alarm(1);
+    irq_set_priority(hardware_alarm_get_irq_num(alarm_pool_timer_alarm_num(io_alarm_pool)), PICO_LOWEST_IRQ_PRIORITY);
+    const auto serviceIoFromTimer = [](repeating_timer_t *timer) {
+        (*static_cast<decltype(&serviceIo)>(timer->user_data))(true);
+        return true;
+    };
+
+    while (true) {
+        serviceIo(false);
+
+        if (queue_try_remove(&auth_challenge_queue, &auth_challenge)) {
+            const uint32_t sign_start_us = time_us_32();
+
+            // Negative interval, i.e. between the end of one and the start of the next run, signing always gets
+            // some time even if serviceIo() is slow.
+            repeating_timer_t io_timer;
+            const bool io_timer_active = alarm_pool_add_repeating_timer_us(
+                io_alarm_pool, -sign_io_interval_us, serviceIoFromTimer, &serviceIo, &io_timer);
+
+            const auto signature = ps4authprovider.sign(auth_challenge.data);
+
+            if (io_timer_active) {
+                cancel_repeating_timer(&io_timer);
+            }
+            auth_sign_time.record(time_us_32() - sign_start_us);
+
+            if (signature) {
+                const AuthMessage signed_challenge = {.request = auth_challenge.request, .data = *signature};
+                queue_try_remove(&auth_signed_challenge_queue, nullptr); // clear queue first
+                queue_try_add(&auth_signed_challenge_queue, &signed_challenge);
+            }
+        }
     }
 }
 
@@ -133,21 +296,26 @@ int main() {
     queue_init(&menu_display_queue, sizeof(Utils::Menu::State), 1);
     queue_init(&drum_input_queue, sizeof(Utils::InputState::Drum), 1);
     queue_init(&controller_input_queue, sizeof(Utils::InputState::Controller), 1);
-    queue_init(&auth_challenge_queue, sizeof(std::array<uint8_t, Utils::PS4AuthProvider::SIGNATURE_LENGTH>), 1);
-    queue_init(&auth_signed_challenge_queue, sizeof(std::array<uint8_t, Utils::PS4AuthProvider::SIGNATURE_LENGTH>), 1);
+    queue_init(&auth_challenge_queue, sizeof(AuthMessage), 1);
+    queue_init(&auth_signed_challenge_queue, sizeof(AuthMessage), 1);
+    queue_init(&core1_stats_queue, sizeof(Core1Stats), 1);
 
     stdio_init_all();
 
-    Peripherals::Drum drum(Config::Default::drum_config);
+    Peripherals::Drum<Config::Default::DrumAdc> drum(Config::Default::drum_config, Config::Default::drum_adc_config);
 
     Utils::InputReport input_report;
+    Utils::CaptureReport capture_report;
     Utils::InputState input_state;
     const auto checkHotkey = [&input_state]() {
         static const uint32_t hold_timeout = 2000;
         static uint32_t hold_since = 0;
         static bool hold_active = false;
 
-        if (input_state.controller.buttons.start && input_state.controller.buttons.select) {
+        static const uint32_t hotkey_mask = Utils::InputState::bit(Utils::InputState::Input::Start) |
+                                            Utils::InputState::bit(Utils::InputState::Input::Select);
+
+        if ((input_state.controller.buttons & hotkey_mask) == hotkey_mask) {
             const uint32_t now = to_ms_since_boot(get_absolute_time());
             if (!hold_active) {
                 hold_active = true;
@@ -161,36 +329,127 @@ int main() {
         }
         return false;
     };
+    // Holding Select and pressing L or R steps to the previous or next profile.
+    const auto checkProfileHotkey = [&input_state]() -> int {
+        static uint32_t previous_buttons = 0;
+
+        const uint32_t pressed = input_state.controller.buttons & ~previous_buttons;
+        previous_buttons = input_state.controller.buttons;
+
+        if (!input_state.controller.isPressed(Utils::InputState::Input::Select)) {
+            return 0;
+        }
+        if (pressed & Utils::InputState::bit(Utils::InputState::Input::L)) {
+            return -1;
+        }
+        if (pressed & Utils::InputState::bit(Utils::InputState::Input::R)) {
+            return 1;
+        }
+        return 0;
+    };
 
     auto settings_store = std::make_shared<Utils::SettingsStore>();
-    const auto mode = settings_store->getUsbMode();
-    const auto readSettings = [&]() {
-        const auto sendCtrlMessage = [&](const ControlMessage &msg) { queue_add_blocking(&control_queue, &msg); };
+    auto mode = settings_store->getUsbMode();
+    const auto sendCtrlMessage = [&](const ControlMessage &msg) { queue_add_blocking(&control_queue, &msg); };
+    const auto applyProfile = [&]() {
+        drum.setDebounceDelay(settings_store->getDebounceDelay());
+        drum.setTriggerThresholds(settings_store->getTriggerThresholds());
+        drum.setDoubleTriggerMode(settings_store->getDoubleTriggerMode());
+        drum.setDoubleThresholds(settings_store->getDoubleTriggerThresholds());
 
+        sendCtrlMessage(
+            {.command = ControlCommand::SetProfile, .data = {.profile = settings_store->getActiveProfile()}});
+        sendCtrlMessage({.command = ControlCommand::SetTriggerThresholds,
+                         .data = {.trigger_thresholds = settings_store->getTriggerThresholds()}});
+    };
+    const auto readSettings = [&]() {
         sendCtrlMessage({.command = ControlCommand::SetUsbMode, .data = {.usb_mode = mode}});
         sendCtrlMessage({.command = ControlCommand::SetLedBrightness,
                          .data = {.led_brightness = settings_store->getLedBrightness()}});
         sendCtrlMessage({.command = ControlCommand::SetLedEnablePlayerColor,
                          .data = {.led_enable_player_color = settings_store->getLedEnablePlayerColor()}});
 
-        drum.setDebounceDelay(settings_store->getDebounceDelay());
-        drum.setTriggerThresholds(settings_store->getTriggerThresholds());
-        drum.setDoubleTriggerMode(settings_store->getDoubleTriggerMode());
-        drum.setDoubleThresholds(settings_store->getDoubleTriggerThresholds());
+        applyProfile();
+
+        input_report.setInputRemap(settings_store->getInputRemap());
     };
 
     Utils::Menu menu(settings_store);
 
-    std::array<uint8_t, Utils::PS4AuthProvider::SIGNATURE_LENGTH> auth_challenge_response{};
+    // Core 0 loop period and ADC sample interval, printed once per second in debug mode to
+    // compare the jitter of different builds, e.g. with and without DONCON_HOT_PATHS_IN_RAM.
+    // Erase and prog timing is accumulated since boot and shows the worst case stall of settings writes,
+    // load is the time needed to parse the settings at boot.
+    // btn is the time core 1 needs to read the buttons including the wait for the I2C bus, gpio the
+    // time until a button change is read and the share of the I2C bus used for button reads, led and disp
+    // the time core 1 needs to render an LED or display frame. io is the time between two rounds of button, LED
+    // and display work on core 1, its maximum the worst stall, and ps4 the time needed to sign a challenge.
+    Utils::TimingStats loop_timing;
+    uint32_t loop_start_us = time_us_32();
+    const auto reportTiming = [&]() {
+        static const uint32_t report_interval_ms = 1000;
+        static uint32_t last_report = 0;
+
+        const uint32_t now = to_ms_since_boot(get_absolute_time());
+        if ((now - last_report) < report_interval_ms) {
+            return;
+        }
+        last_report = now;
+
+        Core1Stats core1_stats{};
+        queue_try_remove(&core1_stats_queue, &core1_stats);
+        const uint32_t bus_permille =
+            core1_stats.interval_ms > 0 ? core1_stats.gpio.bus_time_us / core1_stats.interval_ms : 0;
+
+        Utils::TextBuffer<480> line;
+        loop_timing.format(line, "loop");
+        line.append(' ');
+        drum.takeSampleIntervals().format(line, "adc");
+        line.append(' ');
+        settings_store->getEraseTiming().format(line, "erase");
+        line.append(' ');
+        settings_store->getProgramTiming().format(line, "prog");
+        line.append(" load ").append(settings_store->getLoadTime()).append("us");
+        line.append(' ');
+        core1_stats.read_latency.format(line, "btn");
+        line.append(' ');
+        core1_stats.gpio.latency.format(line, "gpio");
+        line.append(' ').append(core1_stats.gpio.reads).append(" reads ");
+        line.append(bus_permille / 10).append('.').append(bus_permille % 10).append("% bus ");
+        core1_stats.led_frame.format(line, "led");
+        line.append(' ');
+        core1_stats.display_frame.format(line, "disp");
+        line.append(' ');
+        core1_stats.io_interval.format(line, "io");
+        line.append(' ');
+        core1_stats.auth_sign.format(line, "ps4");
+        line.append(" stack ").append(core1_stats.stack_used).append('/');
+        line.append(static_cast<uint32_t>(sizeof(core1_stack))).append('B');
+        line.append('\n');
+        stdio_put_string(line.c_str(), static_cast<int>(line.size()), false, true);
+
+        loop_timing.reset();
+    };
+
+    AuthMessage auth_challenge_response{};
     if (Config::PS4Auth::config.enabled) {
         ps4_auth_init(Config::PS4Auth::config.key_pem.c_str(), Config::PS4Auth::config.key_pem.size() + 1,
                       Config::PS4Auth::config.serial.data(), Config::PS4Auth::config.signature.data(),
-                      [](const uint8_t *challenge) { queue_try_add(&auth_challenge_queue, challenge); });
+                      [](const uint8_t *challenge, const uint32_t request) {
+                          AuthMessage message = {.request = request, .data = {}};
+                          std::copy_n(challenge, message.data.size(), message.data.begin());
+
+                          // A challenge which core 1 did not pick up yet has been superseded by this one.
+                          queue_try_remove(&auth_challenge_queue, nullptr);
+                          queue_try_add(&auth_challenge_queue, &message);
+                      });
     }
 
-    multicore_launch_core1(core1_task);
+    core1_stack.fill(core1_stack_fill);
+    multicore_launch_core1_with_stack(core1_task, core1_stack.data(), sizeof(core1_stack));
 
     usbd_driver_init(mode);
+    capture_report.setEnabled(mode == USB_MODE_CAPTURE);
     usbd_driver_set_player_led_cb([](usb_player_led_t player_led) {
         const auto ctrl_message =
             ControlMessage{.command = ControlCommand::SetPlayerLed, .data = {.player_led = player_led}};
@@ -200,7 +459,12 @@ int main() {
     readSettings();
 
     while (true) {
+        const uint32_t now_us = time_us_32();
+        loop_timing.record(now_us - loop_start_us);
+        loop_start_us = now_us;
+
         drum.updateInputState(input_state);
+        drum_scope.add(input_state.drum);
         queue_try_remove(&controller_input_queue, &input_state.controller);
 
         const auto drum_message = input_state.drum;
@@ -213,6 +477,13 @@ int main() {
             } else {
                 settings_store->store();
 
+                // Mode changes re-enumerate in place, drum sampling continues meanwhile.
+                if (settings_store->getUsbMode() != mode) {
+                    mode = settings_store->getUsbMode();
+                    usbd_driver_switch_mode(mode);
+                    capture_report.setEnabled(mode == USB_MODE_CAPTURE);
+                }
+
                 ControlMessage ctrl_message = {.command = ControlCommand::ExitMenu, .data = {}};
                 queue_add_blocking(&control_queue, &ctrl_message);
             }
@@ -225,15 +496,34 @@ int main() {
 
             ControlMessage ctrl_message{.command = ControlCommand::EnterMenu, .data = {}};
             queue_add_blocking(&control_queue, &ctrl_message);
+
+        } else if (const auto step = checkProfileHotkey(); step != 0) {
+            const auto count = Utils::SettingsStore::PROFILE_COUNT;
+            settings_store->setActiveProfile(
+                static_cast<uint8_t>((settings_store->getActiveProfile() + count + step) % count));
+
+            applyProfile();
         }
 
-        usbd_driver_send_report(input_report.getReport(input_state, mode));
+        if (mode == USB_MODE_CAPTURE) {
+            if (usbd_driver_send_report(capture_report.getReport())) {
+                capture_report.confirm();
+            }
+        } else {
+            usbd_driver_send_report(input_report.getReport(input_state, mode));
+        }
         usbd_driver_task();
 
+        if (mode == USB_MODE_DEBUG) {
+            reportTiming();
+        }
+
+        settings_store->update(menu.active() || input_state.digital() != 0, usbd_driver_is_host_active());
+
         queue_try_add(&drum_input_queue, &drum_message);
 
-        if (queue_try_remove(&auth_signed_challenge_queue, auth_challenge_response.data())) {
-            ps4_auth_set_signed_challenge(auth_challenge_response.data());
+        if (queue_try_remove(&auth_signed_challenge_queue, &auth_challenge_response)) {
+            ps4_auth_set_signed_challenge(auth_challenge_response.data.data(), auth_challenge_response.request);
         }
     }
 
@@ -3,123 +3,209 @@
 #include "hardware/gpio.h"
 #include "pico/time.h"
 
+#include <algorithm>
+#include <bit>
+
 namespace Doncon::Peripherals {
 
-Controller::Button::Button(uint8_t pin) : m_gpio_pin(pin), m_gpio_mask(1 << pin) {}
+namespace {
 
-void Controller::Button::setState(bool state, uint8_t debounce_delay) {
-    if (m_active == state) {
-        return;
-    }
+// Time of the first INT edge since the last read of the expander.
+volatile uint32_t int_edge_us = 0;
+volatile bool int_edge_seen = false;
 
-    // Immediately change the input state, but only allow a change every debounce_delay milliseconds.
-    const uint32_t now = to_ms_since_boot(get_absolute_time());
-    if (m_last_change + debounce_delay <= now) {
-        m_active = state;
-        m_last_change = now;
+void intCallback([[maybe_unused]] uint gpio, [[maybe_unused]] uint32_t events) {
+    if (!int_edge_seen) {
+        int_edge_us = time_us_32();
+        int_edge_seen = true;
     }
 }
 
-Controller::InternalGpio::InternalGpio(const std::map<Id, Button> &buttons) {
-    for (const auto &button : buttons) {
-        gpio_init(button.second.getGpioPin());
-        gpio_set_dir(button.second.getGpioPin(), (bool)GPIO_IN);
-        gpio_pull_up(button.second.getGpioPin());
+void initInputPins(const uint32_t pin_mask) {
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+        if (pin_mask & (1U << pin)) {
+            gpio_init(pin);
+            gpio_set_dir(pin, (bool)GPIO_IN);
+            gpio_pull_up(pin);
+        }
     }
 }
 
-uint32_t Controller::InternalGpio::read() { return ~gpio_get_all(); }
+} // namespace
+
+Utils::InputState::Input ControllerBase::toInput(const Id id) {
+    using Input = Utils::InputState::Input;
+
+    static_assert(static_cast<uint8_t>(Input::Share) - static_cast<uint8_t>(Input::Up) ==
+                      static_cast<uint8_t>(Id::SHARE) - static_cast<uint8_t>(Id::UP),
+                  "Controller Ids must match InputState inputs");
+
+    return static_cast<Input>(static_cast<uint8_t>(Input::Up) + static_cast<uint8_t>(id));
+}
+
+InternalGpio::InternalGpio([[maybe_unused]] const Config &config, const uint32_t pin_mask,
+                           [[maybe_unused]] const uint8_t debounce_delay_ms) {
+    initInputPins(pin_mask);
+}
+
+PioGpio::PioGpio(const Config &config, const uint32_t pin_mask, const uint8_t debounce_delay_ms)
+    : m_pin_base(std::countr_zero(pin_mask)) {
+    const uint pin_count = std::bit_width(pin_mask) - m_pin_base;
+    if (pin_mask == 0 || pin_mask != (((1U << pin_count) - 1) << m_pin_base)) {
+        panic("PioGpio requires contiguous button pins");
+    }
+
+    initInputPins(pin_mask);
 
-Controller::ExternalGpio::ExternalGpio(const Config::ExternalGpio &config)
-    : m_mcp23017(config.i2c.address, config.i2c.block) {
+    buttons_init(config.pio, m_pin_base, pin_count, static_cast<uint32_t>(debounce_delay_ms) * 1000);
+}
+
+ExternalGpio::ExternalGpio(const Config &config, [[maybe_unused]] const uint32_t pin_mask,
+                           [[maybe_unused]] const uint8_t debounce_delay_ms)
+    : m_config(config), m_mcp23017(config.i2c.address, config.i2c.block) {
     m_mcp23017.setDirection(0xFFFF);       // All inputs
     m_mcp23017.setPullup(0xFFFF);          // All on
     m_mcp23017.setReversePolarity(0xFFFF); // All reversed
+
+    if (m_config.interrupt.enabled) {
+        m_mcp23017.setInterruptOnChange(0xFFFF);
+
+        // INT is open-drain and active low
+        gpio_init(m_config.interrupt.pin);
+        gpio_set_dir(m_config.interrupt.pin, (bool)GPIO_IN);
+        gpio_pull_up(m_config.interrupt.pin);
+        gpio_set_irq_enabled_with_callback(m_config.interrupt.pin, GPIO_IRQ_EDGE_FALL, true, &intCallback);
+    }
 }
 
-uint32_t Controller::ExternalGpio::read() { return m_mcp23017.read(); }
+bool ExternalGpio::isReadPending() {
+    if (!m_config.interrupt.enabled) {
+        m_read_pending = true;
+    } else if (!m_read_pending) {
+        // INT stays asserted until the inputs are read, so the level is checked in addition to the edge.
+        m_read_pending = int_edge_seen || !gpio_get(m_config.interrupt.pin) ||
+                         (time_us_32() - m_last_read_us) >= (m_config.interrupt.safety_poll_interval_ms * 1000U);
+    }
 
-void Controller::socdClean(Utils::InputState &input_state) {
+    return m_read_pending;
+}
 
-    // Last input has priority
-    if (input_state.controller.dpad.up && input_state.controller.dpad.down) {
-        if (m_socd_state.lastVertical == Id::DOWN) {
-            input_state.controller.dpad.down = false;
-        } else if (m_socd_state.lastVertical == Id::UP) {
-            input_state.controller.dpad.up = false;
-        }
-    } else if (input_state.controller.dpad.up) {
-        m_socd_state.lastVertical = Id::UP;
-    } else {
-        m_socd_state.lastVertical = Id::DOWN;
+uint32_t ExternalGpio::read() {
+    if (!m_read_pending && m_config.interrupt.enabled) {
+        return m_state;
     }
 
-    if (input_state.controller.dpad.left && input_state.controller.dpad.right) {
-        if (m_socd_state.lastHorizontal == Id::RIGHT) {
-            input_state.controller.dpad.right = false;
-        } else if (m_socd_state.lastHorizontal == Id::LEFT) {
-            input_state.controller.dpad.left = false;
-        }
-    } else if (input_state.controller.dpad.left) {
-        m_socd_state.lastHorizontal = Id::LEFT;
-    } else {
-        m_socd_state.lastHorizontal = Id::RIGHT;
+    const uint32_t start_us = time_us_32();
+    const bool edge_seen = int_edge_seen;
+    int_edge_seen = false;
+
+    m_state = m_mcp23017.read();
+
+    const uint32_t end_us = time_us_32();
+    m_stats.reads++;
+    m_stats.bus_time_us += end_us - start_us;
+
+    // Polling notices a change at most one read interval late, interrupts at most the time since the edge.
+    if (!m_config.interrupt.enabled) {
+        m_stats.latency.record(end_us - m_last_read_us);
+    } else if (edge_seen) {
+        m_stats.latency.record(end_us - int_edge_us);
     }
+
+    m_last_read_us = start_us;
+    m_read_pending = false;
+
+    return m_state;
 }
 
-Controller::Controller(const Config &config) : m_config(config) {
-    m_buttons.emplace(Id::UP, config.pins.dpad.up);
-    m_buttons.emplace(Id::DOWN, config.pins.dpad.down);
-    m_buttons.emplace(Id::LEFT, config.pins.dpad.left);
-    m_buttons.emplace(Id::RIGHT, config.pins.dpad.right);
-    m_buttons.emplace(Id::NORTH, config.pins.buttons.north);
-    m_buttons.emplace(Id::EAST, config.pins.buttons.east);
-    m_buttons.emplace(Id::SOUTH, config.pins.buttons.south);
-    m_buttons.emplace(Id::WEST, config.pins.buttons.west);
-    m_buttons.emplace(Id::L, config.pins.buttons.l);
-    m_buttons.emplace(Id::R, config.pins.buttons.r);
-    m_buttons.emplace(Id::START, config.pins.buttons.start);
-    m_buttons.emplace(Id::SELECT, config.pins.buttons.select);
-    m_buttons.emplace(Id::HOME, config.pins.buttons.home);
-    m_buttons.emplace(Id::SHARE, config.pins.buttons.share);
-
-    std::visit(
-        [this](auto &&config) {
-            using T = std::decay_t<decltype(config)>;
-
-            if constexpr (std::is_same_v<T, Config::InternalGpio>) {
-                m_gpio = std::make_unique<InternalGpio>(m_buttons);
-            } else if constexpr (std::is_same_v<T, Config::ExternalGpio>) {
-                m_gpio = std::make_unique<ExternalGpio>(config);
-            } else {
-                static_assert(false, "Unknown GPIO type!");
-            }
-        },
-        m_config.gpio_config);
+GpioStats ExternalGpio::takeStats() {
+    const auto stats = m_stats;
+    m_stats = {};
+    return stats;
 }
 
-void Controller::updateInputState(Utils::InputState &input_state) {
-    const uint32_t gpio_state = m_gpio->read();
+void ControllerBase::socdClean(Utils::InputState &input_state) {
+    using Input = Utils::InputState::Input;
+
+    auto &buttons = input_state.controller.buttons;
+
+    // Last input has priority
+    const auto clean_axis = [&](const uint32_t first, const uint32_t second) {
+        const uint32_t axis = first | second;
+
+        if ((buttons & axis) == axis) {
+            buttons &= ~(m_socd_last & axis);
+        } else {
+            m_socd_last = (m_socd_last & ~axis) | ((buttons & first) != 0 ? first : second);
+        }
+    };
 
-    for (auto &button : m_buttons) {
-        button.second.setState((gpio_state & button.second.getGpioMask()) != 0, m_config.debounce_delay_ms);
+    clean_axis(Utils::InputState::bit(Input::Up), Utils::InputState::bit(Input::Down));
+    clean_axis(Utils::InputState::bit(Input::Left), Utils::InputState::bit(Input::Right));
+}
+
+ControllerBase::ControllerBase(const Config &config)
+    : m_config(config), m_socd_last(Utils::InputState::bit(Utils::InputState::Input::Down) |
+                                    Utils::InputState::bit(Utils::InputState::Input::Right)) {
+    const std::array<uint8_t, BUTTON_COUNT> pins = {
+        config.pins.dpad.up,       config.pins.dpad.down,    config.pins.dpad.left,   config.pins.dpad.right,
+        config.pins.buttons.north, config.pins.buttons.east, config.pins.buttons.south, config.pins.buttons.west,
+        config.pins.buttons.l,     config.pins.buttons.r,    config.pins.buttons.start, config.pins.buttons.select,
+        config.pins.buttons.home,  config.pins.buttons.share};
+
+    m_pin_mask = 0;
+    for (size_t idx = 0; idx < BUTTON_COUNT; ++idx) {
+        m_mappings[idx] = {.gpio_mask = 1U << pins[idx],
+                           .input_mask = Utils::InputState::bit(toInput(static_cast<Id>(idx)))};
+        m_pin_mask |= m_mappings[idx].gpio_mask;
     }
+}
+
+uint32_t ControllerBase::getPinMask() const { return m_pin_mask; }
+
+uint32_t ControllerBase::debounce(const uint32_t gpio_state) {
+    const uint32_t now = to_ms_since_boot(get_absolute_time());
+    const uint32_t elapsed = std::min<uint32_t>(now - m_last_scan, (1U << DEBOUNCE_COUNTER_BITS) - 1);
+    m_last_scan = now;
 
-    input_state.controller.dpad.up = m_buttons.at(Id::UP).getState();
-    input_state.controller.dpad.down = m_buttons.at(Id::DOWN).getState();
-    input_state.controller.dpad.left = m_buttons.at(Id::LEFT).getState();
-    input_state.controller.dpad.right = m_buttons.at(Id::RIGHT).getState();
-    input_state.controller.buttons.north = m_buttons.at(Id::NORTH).getState();
-    input_state.controller.buttons.east = m_buttons.at(Id::EAST).getState();
-    input_state.controller.buttons.south = m_buttons.at(Id::SOUTH).getState();
-    input_state.controller.buttons.west = m_buttons.at(Id::WEST).getState();
-    input_state.controller.buttons.l = m_buttons.at(Id::L).getState();
-    input_state.controller.buttons.r = m_buttons.at(Id::R).getState();
-    input_state.controller.buttons.start = m_buttons.at(Id::START).getState();
-    input_state.controller.buttons.select = m_buttons.at(Id::SELECT).getState();
-    input_state.controller.buttons.home = m_buttons.at(Id::HOME).getState();
-    input_state.controller.buttons.share = m_buttons.at(Id::SHARE).getState();
+    // Subtract the elapsed time from all counters, counters which underflow have expired.
+    uint32_t borrow = 0;
+    for (size_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+        const uint32_t subtrahend = ((elapsed >> bit) & 1U) != 0 ? ~0U : 0U;
+        const uint32_t plane = m_lock_counter[bit];
+
+        m_lock_counter[bit] = plane ^ subtrahend ^ borrow;
+        borrow = (~plane & (subtrahend | borrow)) | (subtrahend & borrow);
+    }
+
+    uint32_t locked = 0;
+    for (auto &plane : m_lock_counter) {
+        plane &= ~borrow;
+        locked |= plane;
+    }
+
+    // Apply changes of unlocked inputs and lock them again.
+    const uint32_t accepted = (gpio_state ^ m_debounced) & m_pin_mask & ~locked;
+    m_debounced ^= accepted;
+
+    for (size_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+        const uint32_t delay_bit = ((m_config.debounce_delay_ms >> bit) & 1U) != 0 ? accepted : 0U;
+        m_lock_counter[bit] = (m_lock_counter[bit] & ~accepted) | delay_bit;
+    }
+
+    return m_debounced;
+}
+
+void ControllerBase::updateInputState(Utils::InputState &input_state, const uint32_t gpio_state,
+                                      const bool is_debounced) {
+    const uint32_t debounced = is_debounced ? gpio_state : debounce(gpio_state);
+
+    uint32_t buttons = 0;
+    for (const auto &mapping : m_mappings) {
+        buttons |= (debounced & mapping.gpio_mask) != 0 ? mapping.input_mask : 0;
+    }
+    input_state.controller.buttons = buttons;
 
     socdClean(input_state);
 }
-} // namespace Doncon::Peripherals
+} // namespace Doncon::Peripherals
\ No newline at end of file
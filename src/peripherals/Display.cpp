@@ -5,15 +5,15 @@
 
 #include "bitmaps/MenuScreens.h"
 
-#include <list>
-#include <numeric>
-#include <string>
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 namespace Doncon::Peripherals {
 
 namespace {
 
-std::string modeToString(usb_mode_t mode) {
+const char *modeToString(usb_mode_t mode) {
     switch (mode) {
     case USB_MODE_SWITCH_TATACON:
         return "Switch Tatacon";
@@ -39,38 +39,199 @@ std::string modeToString(usb_mode_t mode) {
         return "MIDI";
     case USB_MODE_DEBUG:
         return "Debug";
+    case USB_MODE_CAPTURE:
+        return "Capture";
     }
     return "?";
 }
 
+// Order of the meter rows and scope lanes, as the pads are arranged on the drum.
+constexpr std::array<Utils::InputState::Input, 4> pad_order = {
+    Utils::InputState::Input::KaLeft, Utils::InputState::Input::DonLeft, Utils::InputState::Input::DonRight,
+    Utils::InputState::Input::KaRight};
+
 } // namespace
 
 Display::Display(const Config &config) : m_config(config) {
     m_display.external_vcc = false;
-    ssd1306_init(&m_display, 128, 64, m_config.i2c_address, m_config.i2c_block);
+    ssd1306_init(&m_display, WIDTH, HEIGHT, m_config.i2c_address, m_config.i2c_block);
     ssd1306_clear(&m_display);
 }
 
-void Display::setInputState(const Utils::InputState &state) { m_input_state = state; }
-void Display::setUsbMode(usb_mode_t mode) { m_usb_mode = mode; };
-void Display::setPlayerId(uint8_t player_id) { m_player_id = player_id; };
+void Display::setInputState(const Utils::InputState &state) {
+    // The roll counter is the only part of the input state shown outside of the meter page.
+    if (state.drum.current_roll != m_input_state.drum.current_roll ||
+        state.drum.previous_roll != m_input_state.drum.previous_roll) {
+        m_dirty = true;
+    }
 
-void Display::setMenuState(const Utils::Menu::State &menu_state) { m_menu_state = menu_state; }
+    m_input_state = state;
+}
+void Display::setUsbMode(usb_mode_t mode) {
+    if (mode != m_usb_mode) {
+        m_usb_mode = mode;
+        m_background_valid = false;
+        m_dirty = true;
+    }
+};
+void Display::setPlayerId(uint8_t player_id) {
+    m_dirty |= player_id != m_player_id;
+    m_player_id = player_id;
+};
+void Display::setProfile(uint8_t profile) {
+    m_dirty |= profile != m_profile;
+    m_profile = profile;
+};
+void Display::setTriggerThresholds(const DrumBase::Config::Thresholds &thresholds) {
+    m_dirty |= thresholds.don_left != m_trigger_thresholds.don_left ||
+               thresholds.ka_left != m_trigger_thresholds.ka_left ||
+               thresholds.don_right != m_trigger_thresholds.don_right ||
+               thresholds.ka_right != m_trigger_thresholds.ka_right;
+    m_trigger_thresholds = thresholds;
+}
 
-void Display::showIdle() { m_state = State::Idle; }
-void Display::showMenu() { m_state = State::Menu; }
+void Display::setMenuState(const Utils::Menu::State &menu_state) {
+    m_dirty |= menu_state.page != m_menu_state.page || menu_state.selected_value != m_menu_state.selected_value;
+    m_menu_state = menu_state;
+}
 
-void Display::drawIdleScreen() {
-    // Header
-    const std::string mode_string = modeToString(m_usb_mode) + " mode";
-    ssd1306_draw_string(&m_display, 0, 0, 1, mode_string.c_str());
-    ssd1306_draw_line(&m_display, 0, 10, 128, 10);
+void Display::setIdleView(IdleView view) {
+    m_dirty |= view != m_idle_view;
+    m_idle_view = view;
+}
+Display::IdleView Display::getIdleView() const { return m_idle_view; }
 
-    // Roll counter
-    auto roll_str = std::to_string(m_input_state.drum.current_roll) + " Roll";
-    auto prev_roll_str = "Last " + std::to_string(m_input_state.drum.previous_roll);
-    ssd1306_draw_string(&m_display, (127 - (roll_str.length() * 12)) / 2, 20, 2, roll_str.c_str());
-    ssd1306_draw_string(&m_display, (127 - (prev_roll_str.length() * 6)) / 2, 40, 1, prev_roll_str.c_str());
+bool Display::ScopeHistory::add(const Utils::DrumScope::Sample &sample, const uint8_t decimation) {
+    for (size_t idx = 0; idx < pending.raw.size(); ++idx) {
+        pending.raw[idx] = std::max(pending.raw[idx], sample.raw[idx]);
+    }
+    pending.triggered |= sample.triggered;
+
+    if (++pending_count < decimation) {
+        return false;
+    }
+
+    // Scrolling only changes the picture if the added or the dropped column shows anything.
+    const auto is_empty = [](const Utils::DrumScope::Sample &column) {
+        return column.triggered == 0 && std::ranges::all_of(column.raw, [](const auto raw) { return raw == 0; });
+    };
+    const bool changed = !is_empty(pending) || !is_empty(columns[next]);
+
+    columns[next] = pending;
+    next = (next + 1) % columns.size();
+
+    pending = {};
+    pending_count = 0;
+
+    return changed;
+}
+
+void Display::addScopeSample(const Utils::DrumScope::Sample &sample) {
+    const bool scope_changed = m_scope.add(sample, SCOPE_DECIMATION);
+    const bool timeline_changed = m_timeline.add(sample, TIMELINE_DECIMATION);
+
+    // Scope samples hold the peak of every drum state sampled on core 0, the input state only reaches this core
+    // when the queue is free and would miss short hits. Frames are drawn less often, keep the highest values. The
+    // meter is live, peaks also need to be dropped after a while, so it is redrawn at the full frame rate.
+    if (m_state == State::Menu && m_menu_state.page == Utils::Menu::Page::DrumSignalMeter) {
+        for (size_t idx = 0; idx < m_meter_levels.size(); ++idx) {
+            m_meter_levels[idx] = std::max(m_meter_levels[idx], sample.raw[idx]);
+        }
+        m_dirty = true;
+    }
+
+    if (m_state == State::Idle) {
+        m_dirty |= (m_idle_view == IdleView::Scope && scope_changed) ||
+                   (m_idle_view == IdleView::Timeline && timeline_changed);
+    }
+}
+
+void Display::showIdle() {
+    m_state = State::Idle;
+    m_dirty = true;
+}
+void Display::showMenu() {
+    m_state = State::Menu;
+    m_dirty = true;
+}
+
+void Display::drawBackground() {
+    // Static parts only change with the screen, the menu page or the mode shown in the idle header. They are
+    // drawn once and copied into the framebuffer for every following frame.
+    if (m_background_valid && m_background_state == m_state &&
+        (m_state == State::Idle || m_background_page == m_menu_state.page)) {
+        memcpy(m_display.buffer, m_background.data(), std::min(m_background.size(), m_display.bufsize));
+        return;
+    }
+
+    ssd1306_clear(&m_display);
+
+    switch (m_state) {
+    case State::Idle: {
+        // Header
+        Utils::TextBuffer<24> mode_str;
+        mode_str.append(modeToString(m_usb_mode)).append(" mode");
+        ssd1306_draw_string(&m_display, 0, 0, 1, mode_str.c_str());
+        ssd1306_draw_line(&m_display, 0, 10, 128, 10);
+
+        // Menu hint
+        ssd1306_draw_line(&m_display, 0, 54, 128, 54);
+        ssd1306_draw_string(&m_display, 0, 56, 1, "Hold STA+SEL for Menu");
+    } break;
+    case State::Menu: {
+        const auto &descriptor = Utils::Menu::getDescriptor(m_menu_state.page);
+
+        switch (descriptor.type) {
+        case Utils::Menu::Descriptor::Type::Menu:
+            if (m_menu_state.page == Utils::Menu::Page::Main) {
+                ssd1306_bmp_show_image(&m_display, menu_screen_top.data(), menu_screen_top.size());
+            } else {
+                ssd1306_bmp_show_image(&m_display, menu_screen_sub.data(), menu_screen_sub.size());
+            }
+            break;
+        case Utils::Menu::Descriptor::Type::Value:
+            ssd1306_bmp_show_image(&m_display, menu_screen_value.data(), menu_screen_value.size());
+            break;
+        case Utils::Menu::Descriptor::Type::Selection:
+        case Utils::Menu::Descriptor::Type::Toggle:
+            ssd1306_bmp_show_image(&m_display, menu_screen_sub.data(), menu_screen_sub.size());
+            break;
+        case Utils::Menu::Descriptor::Type::Meter:
+            ssd1306_draw_line(&m_display, 0, 10, 128, 10);
+            for (size_t row = 0; row < descriptor.items.size(); ++row) {
+                const uint32_t y = METER_TOP + (row * METER_ROW_HEIGHT);
+
+                ssd1306_draw_string(&m_display, 5, y, 1, descriptor.items[row].name);
+                ssd13606_draw_empty_square(&m_display, METER_BAR_X, y, METER_BAR_WIDTH, METER_BAR_HEIGHT);
+            }
+            break;
+        case Utils::Menu::Descriptor::Type::RebootInfo:
+            break;
+        }
+
+        // Heading
+        ssd1306_draw_string(&m_display, 0, 0, 1, descriptor.name);
+    } break;
+    }
+
+    memcpy(m_background.data(), m_display.buffer, std::min(m_background.size(), m_display.bufsize));
+    m_background_state = m_state;
+    m_background_page = m_menu_state.page;
+    m_background_valid = true;
+}
+
+void Display::drawIdleScreen() {
+    switch (m_idle_view) {
+    case IdleView::Rolls:
+        drawRolls();
+        break;
+    case IdleView::Scope:
+        drawScope();
+        break;
+    case IdleView::Timeline:
+        drawTimeline();
+        break;
+    }
 
     // Player "LEDs"
     if (m_player_id != 0) {
@@ -82,63 +243,96 @@ void Display::drawIdleScreen() {
             }
         }
     }
+}
+
+void Display::drawRolls() {
+    // Active profile
+    const auto &profiles = Utils::Menu::getDescriptor(Utils::Menu::Page::Profile).items;
+    if (m_profile < profiles.size()) {
+        const auto *profile_str = profiles[m_profile].name;
+        ssd1306_draw_string(&m_display, (127 - (strlen(profile_str) * 6)) / 2, 13, 1, profile_str);
+    }
 
-    // Menu hint
-    ssd1306_draw_line(&m_display, 0, 54, 128, 54);
-    ssd1306_draw_string(&m_display, 0, 56, 1, "Hold STA+SEL for Menu");
+    // Roll counter
+    Utils::TextBuffer<16> roll_str;
+    Utils::TextBuffer<16> prev_roll_str;
+    roll_str.append(m_input_state.drum.current_roll).append(" Roll");
+    prev_roll_str.append("Last ").append(m_input_state.drum.previous_roll);
+    ssd1306_draw_string(&m_display, (127 - (roll_str.size() * 12)) / 2, 23, 2, roll_str.c_str());
+    ssd1306_draw_string(&m_display, (127 - (prev_roll_str.size() * 6)) / 2, 42, 1, prev_roll_str.c_str());
 }
 
-void Display::drawMenuScreen() {
-    auto descriptor_it = Utils::Menu::descriptors.find(m_menu_state.page);
-    if (descriptor_it == Utils::Menu::descriptors.end()) {
-        return;
+void Display::drawScope() {
+    static const uint32_t max_value = 4095;
+    static const uint32_t trace_height = LANE_HEIGHT - 2;
+
+    // Peak level of each column as vertical line from the bottom of the lane, hits marked on the top row.
+    for (uint32_t x = 0; x < WIDTH; ++x) {
+        const auto &column = m_scope.column(x);
+
+        for (size_t lane = 0; lane < pad_order.size(); ++lane) {
+            const auto pad = pad_order[lane];
+            const uint32_t top = LANE_TOP + (lane * LANE_HEIGHT);
+            const uint32_t bottom = top + LANE_HEIGHT - 1;
+            const uint32_t height = (std::min<uint32_t>(column.raw[pad], max_value) * trace_height) / max_value;
+
+            if (height > 0) {
+                ssd1306_draw_line(&m_display, x, bottom, x, bottom - height + 1);
+            }
+            if ((column.triggered & Utils::InputState::bit(pad)) != 0) {
+                ssd1306_draw_pixel(&m_display, x, top);
+            }
+        }
     }
+}
 
-    // Background
-    switch (descriptor_it->second.type) {
-    case Utils::Menu::Descriptor::Type::Menu:
-        if (m_menu_state.page == Utils::Menu::Page::Main) {
-            ssd1306_bmp_show_image(&m_display, menu_screen_top.data(), menu_screen_top.size());
-        } else {
-            ssd1306_bmp_show_image(&m_display, menu_screen_sub.data(), menu_screen_sub.size());
+void Display::drawTimeline() {
+    // Hits as bars on a dotted line per pad.
+    for (uint32_t x = 0; x < WIDTH; ++x) {
+        const auto &column = m_timeline.column(x);
+
+        for (size_t lane = 0; lane < pad_order.size(); ++lane) {
+            const uint32_t top = LANE_TOP + (lane * LANE_HEIGHT);
+
+            if ((column.triggered & Utils::InputState::bit(pad_order[lane])) != 0) {
+                ssd1306_draw_line(&m_display, x, top + 2, x, top + LANE_HEIGHT - 3);
+            } else if ((x % 4) == 0) {
+                ssd1306_draw_pixel(&m_display, x, top + (LANE_HEIGHT / 2));
+            }
         }
-        break;
-    case Utils::Menu::Descriptor::Type::Value:
-        ssd1306_bmp_show_image(&m_display, menu_screen_value.data(), menu_screen_value.size());
-        break;
-    case Utils::Menu::Descriptor::Type::Selection:
-    case Utils::Menu::Descriptor::Type::Toggle:
-        ssd1306_bmp_show_image(&m_display, menu_screen_sub.data(), menu_screen_sub.size());
-        break;
-    case Utils::Menu::Descriptor::Type::RebootInfo:
-        break;
     }
+}
 
-    // Heading
-    ssd1306_draw_string(&m_display, 0, 0, 1, descriptor_it->second.name.c_str());
+void Display::drawMenuScreen() {
+    const auto &descriptor = Utils::Menu::getDescriptor(m_menu_state.page);
 
     // Current Selection
-    std::string selection;
-    switch (descriptor_it->second.type) {
+    Utils::TextBuffer<16> selection;
+    switch (descriptor.type) {
     case Utils::Menu::Descriptor::Type::Menu:
     case Utils::Menu::Descriptor::Type::Selection:
     case Utils::Menu::Descriptor::Type::RebootInfo:
-        selection = descriptor_it->second.items.at(m_menu_state.selected_value).first;
+        if (m_menu_state.selected_value < descriptor.items.size()) {
+            selection.append(descriptor.items[m_menu_state.selected_value].name);
+        }
         break;
     case Utils::Menu::Descriptor::Type::Value:
-        selection = std::to_string(m_menu_state.selected_value);
+        selection.append(static_cast<uint32_t>(m_menu_state.selected_value));
         break;
     case Utils::Menu::Descriptor::Type::Toggle:
-        selection = m_menu_state.selected_value != 0 ? "On" : "Off";
+        selection.append(m_menu_state.selected_value != 0 ? "On" : "Off");
+        break;
+    case Utils::Menu::Descriptor::Type::Meter:
+        drawSignalMeter();
         break;
     }
-    ssd1306_draw_string(&m_display, (127 - (selection.length() * 12)) / 2, 15, 2, selection.c_str());
+    ssd1306_draw_string(&m_display, (127 - (selection.size() * 12)) / 2, 15, 2, selection.c_str());
 
     // Breadcrumbs
-    switch (descriptor_it->second.type) {
+    switch (descriptor.type) {
     case Utils::Menu::Descriptor::Type::Menu:
     case Utils::Menu::Descriptor::Type::Selection: {
-        auto selection_count = descriptor_it->second.items.size();
+        auto selection_count = descriptor.items.size();
         for (size_t i = 0; i < selection_count; ++i) {
             if (i == m_menu_state.selected_value) {
                 ssd1306_draw_square(&m_display, ((127) - ((selection_count - i) * 6)) - 1, 2, 4, 4);
@@ -150,19 +344,81 @@ void Display::drawMenuScreen() {
     case Utils::Menu::Descriptor::Type::RebootInfo:
     case Utils::Menu::Descriptor::Type::Value:
     case Utils::Menu::Descriptor::Type::Toggle:
+    case Utils::Menu::Descriptor::Type::Meter:
         break;
     }
 }
 
+void Display::drawSignalMeter() {
+    static const uint32_t peak_hold_ms = 1000;
+    static const uint16_t max_value = 4095;
+
+    const std::array<uint16_t, 4> thresholds = {m_trigger_thresholds.ka_left, m_trigger_thresholds.don_left,
+                                                m_trigger_thresholds.don_right, m_trigger_thresholds.ka_right};
+
+    const auto &items = Utils::Menu::getDescriptor(Utils::Menu::Page::DrumSignalMeter).items;
+    const auto to_x = [](const uint16_t value) {
+        return METER_BAR_X + ((std::min(value, max_value) * (METER_BAR_WIDTH - 1)) / max_value);
+    };
+    const uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    // Threshold of the selected pad
+    if (m_menu_state.selected_value < thresholds.size()) {
+        Utils::TextBuffer<8> threshold_str;
+        threshold_str.append(static_cast<uint32_t>(thresholds[m_menu_state.selected_value]));
+        ssd1306_draw_string(&m_display, 127 - (threshold_str.size() * 6), 0, 1, threshold_str.c_str());
+    }
+
+    for (size_t row = 0; row < pad_order.size() && row < items.size(); ++row) {
+        const auto pad = pad_order[row];
+        const uint32_t y = METER_TOP + (row * METER_ROW_HEIGHT);
+
+        if (m_meter_levels[pad] >= m_meter_peaks[pad] || (now - m_meter_peak_times[pad]) > peak_hold_ms) {
+            m_meter_peaks[pad] = m_meter_levels[pad];
+            m_meter_peak_times[pad] = now;
+        }
+
+        if (row == m_menu_state.selected_value) {
+            ssd1306_draw_square(&m_display, 0, y + 2, 3, 3);
+        }
+
+        // Live level as bar, the held peak as marker inside and the threshold as line across the bar.
+        ssd1306_draw_square(&m_display, METER_BAR_X, y, to_x(m_meter_levels[pad]) - METER_BAR_X + 1, METER_BAR_HEIGHT);
+        ssd1306_draw_line(&m_display, to_x(m_meter_peaks[pad]), y, to_x(m_meter_peaks[pad]),
+                          y + METER_BAR_HEIGHT - 1);
+        ssd1306_draw_line(&m_display, to_x(thresholds[row]), y - 2, to_x(thresholds[row]), y + METER_BAR_HEIGHT + 1);
+
+        m_meter_levels[pad] = 0;
+    }
+}
+
 void Display::update() {
-    static const uint32_t interval_ms = 17; // Limit to ~60fps
+    static const uint32_t min_interval_ms = 17; // Limit to ~60fps while the content keeps changing
 
-    if (to_ms_since_boot(get_absolute_time()) - m_next_frame_time < interval_ms) {
+    // Frames are only drawn after something visible changed, an idle screen neither takes time to draw nor
+    // occupies the I2C bus. Frames which end up identical anyway are not sent by ssd1306_show_async(). A frame
+    // dropped after a NACK left the display with partial content, it needs to be sent again.
+    m_dirty |= ssd1306_show_aborted(&m_display);
+    if (!m_dirty) {
         return;
     }
-    m_next_frame_time += interval_ms;
 
-    ssd1306_clear(&m_display);
+    // Previous frame is still being sent in chunks via sendChunk(), the framebuffer could be redrawn but not
+    // pushed anyway.
+    if (!ssd1306_show_done(&m_display)) {
+        return;
+    }
+
+    const uint32_t now = to_ms_since_boot(get_absolute_time());
+    if ((now - m_last_frame_time) < min_interval_ms) {
+        return;
+    }
+    m_last_frame_time = now;
+    m_dirty = false;
+
+    const uint32_t start_us = time_us_32();
+
+    drawBackground();
 
     switch (m_state) {
     case State::Idle:
@@ -173,7 +429,18 @@ void Display::update() {
         break;
     }
 
-    ssd1306_show(&m_display);
+    m_render_time.record(time_us_32() - start_us);
+
+    ssd1306_show_async(&m_display);
 };
 
+Utils::TimingStats Display::takeRenderTime() {
+    const auto stats = m_render_time;
+    m_render_time.reset();
+    return stats;
+}
+
+bool Display::isChunkDone() { return ssd1306_show_chunk_done(&m_display); }
+void Display::sendChunk() { ssd1306_show_continue(&m_display); }
+
 } // namespace Doncon::Peripherals
\ No newline at end of file
@@ -1,14 +1,28 @@
 #include "peripherals/Drum.h"
 
+#include "utils/HotPath.h"
+
 #include "hardware/adc.h"
 #include "pico/time.h"
-#include <mcp3204/Mcp3204Dma.h>
 
 #include <algorithm>
+#include <bit>
 
 namespace Doncon::Peripherals {
 
-Drum::InternalAdc::InternalAdc(const Config::InternalAdc &config) : m_config(config) {
+Utils::InputState::Input DrumBase::toInput(const Id id) {
+    using Input = Utils::InputState::Input;
+
+    static_assert(static_cast<uint8_t>(Id::DON_LEFT) == static_cast<uint8_t>(Input::DonLeft) &&
+                      static_cast<uint8_t>(Id::KA_LEFT) == static_cast<uint8_t>(Input::KaLeft) &&
+                      static_cast<uint8_t>(Id::DON_RIGHT) == static_cast<uint8_t>(Input::DonRight) &&
+                      static_cast<uint8_t>(Id::KA_RIGHT) == static_cast<uint8_t>(Input::KaRight),
+                  "Drum Ids must match InputState inputs");
+
+    return static_cast<Input>(id);
+}
+
+InternalAdc::InternalAdc(const Config &config) : m_config(config) {
     static const uint adc_base_pin = 26;
 
     for (uint pin = adc_base_pin; pin < adc_base_pin + 4; ++pin) {
@@ -18,7 +32,7 @@ Drum::InternalAdc::InternalAdc(const Config::InternalAdc &config) : m_config(con
     adc_init();
 }
 
-std::array<uint16_t, 4> Drum::InternalAdc::read() {
+std::array<uint16_t, 4> HOT_PATH_FUNC(InternalAdc::read)() {
     if (m_config.sample_count == 0) {
         return {};
     }
@@ -39,7 +53,7 @@ std::array<uint16_t, 4> Drum::InternalAdc::read() {
     return result;
 }
 
-Drum::ExternalAdc::ExternalAdc(const Config::ExternalAdc &config) {
+ExternalAdc::ExternalAdc(const Config &config) {
     // Enable level shifter
     gpio_init(config.spi_level_shifter_enable_pin);
     gpio_set_dir(config.spi_level_shifter_enable_pin, (bool)GPIO_OUT);
@@ -57,115 +71,94 @@ Drum::ExternalAdc::ExternalAdc(const Config::ExternalAdc &config) {
     Mcp3204Dma::run(config.spi_block, config.spi_scsn_pin);
 }
 
-std::array<uint16_t, 4> Drum::ExternalAdc::read() { return Mcp3204Dma::take_maximums(); }
+DrumBase::Pad::Pad(const uint8_t channel) : m_channel(channel) {}
 
-Drum::Pad::Pad(const uint8_t channel) : m_channel(channel) {}
-
-void Drum::Pad::setState(const bool state, const uint16_t debounce_delay) {
+void HOT_PATH_FUNC(DrumBase::Pad::setState)(const bool state, const uint16_t debounce_delay) {
     if (m_active == state) {
         return;
     }
 
     // Immediately change the input state, but only allow a change every debounce_delay milliseconds.
-    const uint32_t now = to_ms_since_boot(get_absolute_time());
-    if (m_last_change + debounce_delay <= now) {
+    const uint32_t now = time_us_32();
+    if ((now - m_last_change) >= (debounce_delay * 1000U)) {
         m_active = state;
         m_last_change = now;
     }
 }
 
-uint16_t Drum::Pad::getAnalog() {
+uint16_t HOT_PATH_FUNC(DrumBase::Pad::getAnalog)() {
     const auto raw_to_uint16 = [](uint16_t raw) { return ((raw << 4) & 0xFFF0) | ((raw >> 8) & 0x000F); };
 
-    return raw_to_uint16(std::ranges::max_element(m_analog_buffer, [](const auto &a, const auto &b) {
-                             return a.value < b.value;
-                         })->value);
+    uint16_t max_value = 0;
+    for (size_t idx = 0; idx < m_analog_buffer_count; ++idx) {
+        max_value = std::max(max_value, analogEntry(idx).value);
+    }
+
+    return raw_to_uint16(max_value);
 }
 
-void Drum::Pad::setAnalog(uint16_t value, uint16_t debounce_delay) {
-    const uint32_t now = to_ms_since_boot(get_absolute_time());
+void HOT_PATH_FUNC(DrumBase::Pad::setAnalog)(uint16_t value, uint16_t debounce_delay) {
+    const uint32_t now = time_us_32();
+    const uint32_t debounce_delay_us = debounce_delay * 1000U;
 
     // Clear outdated values, i.e. anything older than debounce_delay to allow for convenient configuration.
-    while (!m_analog_buffer.empty() && (m_analog_buffer.front().timestamp + debounce_delay) <= now) {
-        m_analog_buffer.pop_front();
+    while (m_analog_buffer_count > 0 && (now - analogEntry(0).timestamp) >= debounce_delay_us) {
+        m_analog_buffer_head = (m_analog_buffer_head + 1) & (ANALOG_BUFFER_CAPACITY - 1);
+        --m_analog_buffer_count;
     }
 
-    m_analog_buffer.push_back({value, now});
+    if (m_analog_buffer_count > 0) {
+        auto &newest = analogEntry(m_analog_buffer_count - 1);
+        if ((now - newest.timestamp) < 1000) {
+            newest.value = std::max(newest.value, value);
+            return;
+        }
+    }
+
+    // Drop the oldest value if the debounce delay is longer than the buffer.
+    if (m_analog_buffer_count == ANALOG_BUFFER_CAPACITY) {
+        m_analog_buffer_head = (m_analog_buffer_head + 1) & (ANALOG_BUFFER_CAPACITY - 1);
+        --m_analog_buffer_count;
+    }
+
+    analogEntry(m_analog_buffer_count) = {.value = value, .timestamp = now};
+    ++m_analog_buffer_count;
 }
 
-Drum::RollCounter::RollCounter(uint32_t timeout_ms) : m_timeout_ms(timeout_ms) {};
+DrumBase::RollCounter::RollCounter(uint32_t timeout_ms) : m_timeout_ms(timeout_ms) {};
 
-void Drum::RollCounter::update(Utils::InputState &input_state) {
-    const uint32_t now = to_ms_since_boot(get_absolute_time());
-    if ((now - m_last_hit_time) > m_timeout_ms) {
+void HOT_PATH_FUNC(DrumBase::RollCounter::update)(Utils::InputState &input_state) {
+    const uint32_t now = time_us_32();
+    if ((now - m_last_hit_time) > (m_timeout_ms * 1000U)) {
         if (m_current_roll > 1) {
             m_previous_roll = m_current_roll;
         }
         m_current_roll = 0;
     }
 
-    if (input_state.drum.don_left.triggered && (m_previous_pad_state.don_left != input_state.drum.don_left.triggered)) {
-        m_last_hit_time = now;
-        m_current_roll++;
-    }
-    if (input_state.drum.don_right.triggered &&
-        (m_previous_pad_state.don_right != input_state.drum.don_right.triggered)) {
-        m_last_hit_time = now;
-        m_current_roll++;
-    }
-    if (input_state.drum.ka_right.triggered && (m_previous_pad_state.ka_right != input_state.drum.ka_right.triggered)) {
-        m_last_hit_time = now;
-        m_current_roll++;
-    }
-    if (input_state.drum.ka_left.triggered && (m_previous_pad_state.ka_left != input_state.drum.ka_left.triggered)) {
+    const uint32_t new_hits = input_state.drum.triggered & ~m_previous_triggered;
+    if (new_hits != 0) {
         m_last_hit_time = now;
-        m_current_roll++;
+        m_current_roll += std::popcount(new_hits);
     }
 
-    m_previous_pad_state.don_left = input_state.drum.don_left.triggered;
-    m_previous_pad_state.don_right = input_state.drum.don_right.triggered;
-    m_previous_pad_state.ka_left = input_state.drum.ka_left.triggered;
-    m_previous_pad_state.ka_right = input_state.drum.ka_right.triggered;
+    m_previous_triggered = input_state.drum.triggered;
 
     input_state.drum.current_roll = m_current_roll;
     input_state.drum.previous_roll = m_previous_roll;
 }
 
-Drum::Drum(const Config &config) : m_config(config), m_roll_counter(config.roll_counter_timeout_ms) {
-
-    std::visit(
-        [this](auto &&config) {
-            using T = std::decay_t<decltype(config)>;
-
-            if constexpr (std::is_same_v<T, Config::InternalAdc>) {
-                m_adc = std::make_unique<InternalAdc>(config);
-            } else if constexpr (std::is_same_v<T, Config::ExternalAdc>) {
-                m_adc = std::make_unique<ExternalAdc>(config);
-            } else {
-                static_assert(false, "Unknown ADC type!");
-            }
-        },
-        m_config.adc_config);
-
-    m_pads.emplace(Id::DON_LEFT, config.adc_channels.don_left);
-    m_pads.emplace(Id::KA_LEFT, config.adc_channels.ka_left);
-    m_pads.emplace(Id::DON_RIGHT, config.adc_channels.don_right);
-    m_pads.emplace(Id::KA_RIGHT, config.adc_channels.ka_right);
-}
-
-std::map<Drum::Id, uint16_t> Drum::readInputs() {
-    std::map<Id, uint16_t> result;
-
-    const auto adc_values = m_adc->read();
-
-    for (const auto &[id, pad] : m_pads) {
-        result[id] = adc_values.at(pad.getChannel());
+DrumBase::DrumBase(const Config &config)
+    : m_config(config), m_pads{{config.adc_channels.don_left, config.adc_channels.ka_left,
+                                config.adc_channels.don_right, config.adc_channels.ka_right}},
+      m_roll_counter(config.roll_counter_timeout_ms) {
+    if (std::ranges::any_of(m_pads, [](const auto &pad) { return pad.getChannel() >= ADC_CHANNEL_COUNT; })) {
+        panic("Drum ADC channel out of range");
     }
-
-    return result;
 }
 
-void Drum::updateDigitalInputState(Utils::InputState &input_state, const std::map<Drum::Id, uint16_t> &raw_values) {
+void HOT_PATH_FUNC(DrumBase::updateDigitalInputState)(Utils::InputState &input_state,
+                                                      const RawValues &raw_values) {
     const auto resolve_twin_pads = [&](Id left, Id right) {
         const auto is_over_threshold = [&raw_values](const Id target, const auto &thresholds) {
             const auto get_threshold = [&thresholds](const Id target) {
@@ -182,35 +175,35 @@ void Drum::updateDigitalInputState(Utils::InputState &input_state, const std::ma
                 assert(false);
                 return (uint16_t)0;
             };
-            return (raw_values.at(target) > get_threshold(target));
+            return (raw(raw_values, target) > get_threshold(target));
         };
 
         const auto resolve_single_trigger = [&]() {
             if (!is_over_threshold(left, m_config.trigger_thresholds) &&
                 !is_over_threshold(right, m_config.trigger_thresholds)) {
 
-                m_pads.at(left).setState(false, m_config.debounce_delay_ms);
-                m_pads.at(right).setState(false, m_config.debounce_delay_ms);
+                pad(left).setState(false, m_config.debounce_delay_ms);
+                pad(right).setState(false, m_config.debounce_delay_ms);
                 return;
             }
 
             // Trigger twin pad if within 50% of hit strength to allow
             // simultaneous hits while still rejecting unintended double hits.
-            if (raw_values.at(left) > raw_values.at(right)) {
-                m_pads.at(left).setState(true, m_config.debounce_delay_ms);
+            if (raw(raw_values, left) > raw(raw_values, right)) {
+                pad(left).setState(true, m_config.debounce_delay_ms);
 
-                if (raw_values.at(right) > (raw_values.at(left) >> 1)) {
-                    m_pads.at(right).setState(true, m_config.debounce_delay_ms);
+                if (raw(raw_values, right) > (raw(raw_values, left) >> 1)) {
+                    pad(right).setState(true, m_config.debounce_delay_ms);
                 } else {
-                    m_pads.at(right).setState(false, m_config.debounce_delay_ms);
+                    pad(right).setState(false, m_config.debounce_delay_ms);
                 }
             } else {
-                m_pads.at(right).setState(true, m_config.debounce_delay_ms);
+                pad(right).setState(true, m_config.debounce_delay_ms);
 
-                if (raw_values.at(left) > (raw_values.at(right) >> 1)) {
-                    m_pads.at(left).setState(true, m_config.debounce_delay_ms);
+                if (raw(raw_values, left) > (raw(raw_values, right) >> 1)) {
+                    pad(left).setState(true, m_config.debounce_delay_ms);
                 } else {
-                    m_pads.at(left).setState(false, m_config.debounce_delay_ms);
+                    pad(left).setState(false, m_config.debounce_delay_ms);
                 }
             }
         };
@@ -223,8 +216,8 @@ void Drum::updateDigitalInputState(Utils::InputState &input_state, const std::ma
             if (is_over_threshold(left, m_config.double_trigger_thresholds) ||
                 is_over_threshold(right, m_config.double_trigger_thresholds)) {
 
-                m_pads.at(left).setState(true, m_config.debounce_delay_ms);
-                m_pads.at(right).setState(true, m_config.debounce_delay_ms);
+                pad(left).setState(true, m_config.debounce_delay_ms);
+                pad(right).setState(true, m_config.debounce_delay_ms);
             } else {
                 resolve_single_trigger();
             }
@@ -233,79 +226,70 @@ void Drum::updateDigitalInputState(Utils::InputState &input_state, const std::ma
             if (is_over_threshold(left, m_config.trigger_thresholds) ||
                 is_over_threshold(right, m_config.trigger_thresholds)) {
 
-                m_pads.at(left).setState(true, m_config.debounce_delay_ms);
-                m_pads.at(right).setState(true, m_config.debounce_delay_ms);
+                pad(left).setState(true, m_config.debounce_delay_ms);
+                pad(right).setState(true, m_config.debounce_delay_ms);
             } else {
-                m_pads.at(left).setState(false, m_config.debounce_delay_ms);
-                m_pads.at(right).setState(false, m_config.debounce_delay_ms);
+                pad(left).setState(false, m_config.debounce_delay_ms);
+                pad(right).setState(false, m_config.debounce_delay_ms);
             }
             break;
         }
     };
 
     // Either DON or KA can be active at a time
-    if (std::max(raw_values.at(Id::DON_LEFT), raw_values.at(Id::DON_RIGHT)) >
-        std::max(raw_values.at(Id::KA_LEFT), raw_values.at(Id::KA_RIGHT))) {
+    if (std::max(raw(raw_values, Id::DON_LEFT), raw(raw_values, Id::DON_RIGHT)) >
+        std::max(raw(raw_values, Id::KA_LEFT), raw(raw_values, Id::KA_RIGHT))) {
 
         resolve_twin_pads(Id::DON_LEFT, Id::DON_RIGHT);
 
-        m_pads.at(Id::KA_LEFT).setState(false, m_config.debounce_delay_ms);
-        m_pads.at(Id::KA_RIGHT).setState(false, m_config.debounce_delay_ms);
+        pad(Id::KA_LEFT).setState(false, m_config.debounce_delay_ms);
+        pad(Id::KA_RIGHT).setState(false, m_config.debounce_delay_ms);
     } else {
         resolve_twin_pads(Id::KA_LEFT, Id::KA_RIGHT);
 
-        m_pads.at(Id::DON_LEFT).setState(false, m_config.debounce_delay_ms);
-        m_pads.at(Id::DON_RIGHT).setState(false, m_config.debounce_delay_ms);
+        pad(Id::DON_LEFT).setState(false, m_config.debounce_delay_ms);
+        pad(Id::DON_RIGHT).setState(false, m_config.debounce_delay_ms);
     }
 
-    input_state.drum.don_left.triggered = m_pads.at(Id::DON_LEFT).getState();
-    input_state.drum.ka_left.triggered = m_pads.at(Id::KA_LEFT).getState();
-    input_state.drum.don_right.triggered = m_pads.at(Id::DON_RIGHT).getState();
-    input_state.drum.ka_right.triggered = m_pads.at(Id::KA_RIGHT).getState();
+    uint32_t triggered = 0;
+    for (size_t idx = 0; idx < m_pads.size(); ++idx) {
+        if (m_pads[idx].getState()) {
+            triggered |= Utils::InputState::bit(toInput(static_cast<Id>(idx)));
+        }
+    }
+    input_state.drum.triggered = triggered;
 
     m_roll_counter.update(input_state);
 }
 
-void Drum::updateAnalogInputState(Utils::InputState &input_state, const std::map<Drum::Id, uint16_t> &raw_values) {
-    for (const auto &[id, raw] : raw_values) {
-        m_pads.at(id).setAnalog(raw, m_config.debounce_delay_ms);
+void HOT_PATH_FUNC(DrumBase::updateAnalogInputState)(Utils::InputState &input_state,
+                                                     const RawValues &raw_values) {
+    for (size_t idx = 0; idx < m_pads.size(); ++idx) {
+        m_pads[idx].setAnalog(raw_values[idx], m_config.debounce_delay_ms);
 
-        switch (id) {
-        case Id::DON_LEFT:
-            input_state.drum.don_left.analog = m_pads.at(id).getAnalog();
-            break;
-        case Id::DON_RIGHT:
-            input_state.drum.don_right.analog = m_pads.at(id).getAnalog();
-            break;
-        case Id::KA_LEFT:
-            input_state.drum.ka_left.analog = m_pads.at(id).getAnalog();
-            break;
-        case Id::KA_RIGHT:
-            input_state.drum.ka_right.analog = m_pads.at(id).getAnalog();
-            break;
-        }
+        input_state.drum.analog[toInput(static_cast<Id>(idx))] = m_pads[idx].getAnalog();
     };
 }
 
-void Drum::updateInputState(Utils::InputState &input_state) {
-    const auto raw_values = readInputs();
+void HOT_PATH_FUNC(DrumBase::updateInputState)(Utils::InputState &input_state, const AdcValues &adc_values) {
+    RawValues raw_values{};
+    for (size_t idx = 0; idx < m_pads.size(); ++idx) {
+        raw_values[idx] = adc_values[m_pads[idx].getChannel()];
 
-    input_state.drum.don_left.raw = raw_values.at(Id::DON_LEFT);
-    input_state.drum.don_right.raw = raw_values.at(Id::DON_RIGHT);
-    input_state.drum.ka_left.raw = raw_values.at(Id::KA_LEFT);
-    input_state.drum.ka_right.raw = raw_values.at(Id::KA_RIGHT);
+        input_state.drum.raw[toInput(static_cast<Id>(idx))] = raw_values[idx];
+    }
 
     updateDigitalInputState(input_state, raw_values);
     updateAnalogInputState(input_state, raw_values);
 }
 
-void Drum::setDebounceDelay(const uint16_t delay) { m_config.debounce_delay_ms = delay; }
+void DrumBase::setDebounceDelay(const uint16_t delay) { m_config.debounce_delay_ms = delay; }
 
-void Drum::setTriggerThresholds(const Config::Thresholds &thresholds) { m_config.trigger_thresholds = thresholds; }
+void DrumBase::setTriggerThresholds(const Config::Thresholds &thresholds) { m_config.trigger_thresholds = thresholds; }
 
-void Drum::setDoubleTriggerMode(const Config::DoubleTriggerMode mode) { m_config.double_trigger_mode = mode; }
+void DrumBase::setDoubleTriggerMode(const Config::DoubleTriggerMode mode) { m_config.double_trigger_mode = mode; }
 
-void Drum::setDoubleThresholds(const Config::Thresholds &thresholds) {
+void DrumBase::setDoubleThresholds(const Config::Thresholds &thresholds) {
     m_config.double_trigger_thresholds = thresholds;
 }
 
@@ -1,69 +1,180 @@
 #include "peripherals/StatusLed.h"
 
 #include "hardware/gpio.h"
+#include "pico/time.h"
 #include "pio_ws2812/ws2812.h"
 
 #include <algorithm>
 
 namespace Doncon::Peripherals {
 
-StatusLed::StatusLed(const Config &config) : m_config(config) {
+namespace {
+
+using Color = StatusLed::Config::Color;
+
+// Scales a color by factor/256, factor 255 keeps the color unchanged.
+Color scale(const Color &color, const uint32_t factor) {
+    return {.r = static_cast<uint8_t>((color.r * (factor + 1)) >> 8),
+            .g = static_cast<uint8_t>((color.g * (factor + 1)) >> 8),
+            .b = static_cast<uint8_t>((color.b * (factor + 1)) >> 8)};
+}
+
+Color blend(const Color &from, const Color &to, const uint8_t amount) {
+    const auto a = scale(from, UINT8_MAX - amount);
+    const auto b = scale(to, amount);
+    return {.r = static_cast<uint8_t>(a.r + b.r),
+            .g = static_cast<uint8_t>(a.g + b.g),
+            .b = static_cast<uint8_t>(a.b + b.b)};
+}
+
+void add_color(Color &base, const Color &add) {
+    base.r = std::max(base.r, add.r);
+    base.g = std::max(base.g, add.g);
+    base.b = std::max(base.b, add.b);
+}
+
+} // namespace
+
+StatusLed::StatusLed(const Config &config)
+    : m_config(config), m_zones{{config.zones.don_left, config.zones.ka_left, config.zones.don_right,
+                                 config.zones.ka_right}},
+      m_colors{{config.don_left_color, config.ka_left_color, config.don_right_color, config.ka_right_color}},
+      m_frame_interval_us(1000000 / std::max<uint16_t>(config.frame_rate, 1)),
+      m_frame(std::max<uint16_t>(config.led_count, 1), 0) {
     gpio_init(m_config.led_enable_pin);
     gpio_set_dir(m_config.led_enable_pin, (bool)GPIO_OUT);
     gpio_put(m_config.led_enable_pin, true);
 
     ws2812_init(pio0, config.led_pin, m_config.is_rgbw);
+    ws2812_init_dma(pio0, m_frame.size());
+    ws2812_build_brightness_lut(m_config.brightness, m_brightness_lut.data());
 }
 
-void StatusLed::setBrightness(const uint8_t brightness) { m_config.brightness = brightness; }
+void StatusLed::setBrightness(const uint8_t brightness) {
+    if (brightness != m_config.brightness) {
+        m_config.brightness = brightness;
+        ws2812_build_brightness_lut(m_config.brightness, m_brightness_lut.data());
+    }
+}
 void StatusLed::setEnablePlayerColor(const bool do_enable) { m_config.enable_player_color = do_enable; }
 
 void StatusLed::setInputState(const Utils::InputState &input_state) { m_input_state = input_state; }
 void StatusLed::setPlayerColor(const Config::Color &color) { m_player_color = color; }
 
-void StatusLed::update() {
-    const float brightness_factor = (float)m_config.brightness / (float)UINT8_MAX;
+void StatusLed::updatePads(const uint32_t now_us) {
+    for (size_t idx = 0; idx < m_pads.size(); ++idx) {
+        auto &pad = m_pads[idx];
+        const auto input = static_cast<Utils::InputState::Input>(idx);
 
-    Config::Color mixed = {};
-    bool triggered = false;
+        if (m_input_state.drum.isTriggered(input)) {
+            // Analog values are scaled to 16 bit, keep the peak of the hit as its velocity.
+            pad.velocity = std::max(pad.velocity, static_cast<uint8_t>(m_input_state.drum.analog[input] >> 8));
+            pad.active = true;
+        } else if (pad.active) {
+            pad.active = false;
+            pad.release_us = now_us;
+            pad.trail_us = (m_config.trail_ms * 1000U * pad.velocity) / UINT8_MAX;
+            pad.velocity = 0;
+        }
+    }
 
-    const auto add_color = [](Config::Color &base, const Config::Color &add) {
-        base.r = std::max(base.r, add.r);
-        base.g = std::max(base.g, add.g);
-        base.b = std::max(base.b, add.b);
-    };
+    if (m_input_state.drum.current_roll == 0) {
+        m_roll_start_us = 0;
+    } else if (m_roll_start_us == 0) {
+        m_roll_start_us = now_us | 1U; // 0 is reserved for no roll
+    }
+}
 
-    if (m_input_state.drum.don_left.triggered) {
-        add_color(mixed, m_config.don_left_color);
-        triggered = true;
+uint8_t StatusLed::getRollRamp(const uint32_t now_us) const {
+    if (m_input_state.drum.current_roll < 2 || m_config.roll_full_speed == 0) {
+        return 0;
     }
-    if (m_input_state.drum.ka_left.triggered) {
-        add_color(mixed, m_config.ka_left_color);
-        triggered = true;
+
+    const uint32_t elapsed_ms = (now_us - m_roll_start_us) / 1000;
+    if (elapsed_ms == 0) {
+        return 0;
+    }
+
+    // Hits per second times 256 since the roll started, the first hit only starts the measurement.
+    const uint32_t speed = ((m_input_state.drum.current_roll - 1U) * 1000U * 256U) / elapsed_ms;
+
+    return static_cast<uint8_t>(std::min<uint32_t>(speed / m_config.roll_full_speed, UINT8_MAX));
+}
+
+void StatusLed::render(const uint32_t now_us) {
+    const uint8_t roll_ramp = getRollRamp(now_us);
+
+    Utils::InputState::PadArray<uint8_t> levels{};
+    Utils::InputState::PadArray<Color> colors{};
+    for (size_t idx = 0; idx < m_pads.size(); ++idx) {
+        auto &pad = m_pads[idx];
+
+        if (pad.active) {
+            levels[idx] = UINT8_MAX;
+        } else if (pad.trail_us > 0) {
+            const uint32_t elapsed_us = now_us - pad.release_us;
+            if (elapsed_us >= pad.trail_us) {
+                pad.trail_us = 0;
+            } else {
+                levels[idx] = static_cast<uint8_t>(UINT8_MAX - ((uint64_t)elapsed_us * UINT8_MAX) / pad.trail_us);
+            }
+        }
+
+        colors[idx] = scale(blend(m_colors[idx], m_config.roll_color, roll_ramp), levels[idx]);
     }
-    if (m_input_state.drum.don_right.triggered) {
-        add_color(mixed, m_config.don_right_color);
-        triggered = true;
+
+    const auto idle_color =
+        m_config.enable_player_color ? m_player_color.value_or(m_config.idle_color) : m_config.idle_color;
+
+    for (size_t led = 0; led < m_frame.size(); ++led) {
+        Color mixed = {};
+        uint8_t level = 0;
+
+        for (size_t idx = 0; idx < m_zones.size(); ++idx) {
+            if (levels[idx] > 0 && (led - m_zones[idx].first) < m_zones[idx].count) {
+                add_color(mixed, colors[idx]);
+                level = std::max(level, levels[idx]);
+            }
+        }
+        add_color(mixed, scale(idle_color, UINT8_MAX - level));
+
+        const uint32_t pixel =
+            ws2812_rgb_to_u32pixel(m_brightness_lut[mixed.r], m_brightness_lut[mixed.g], m_brightness_lut[mixed.b]);
+        if (m_frame[led] != pixel) {
+            m_frame[led] = pixel;
+            m_frame_pending = true;
+        }
     }
-    if (m_input_state.drum.ka_right.triggered) {
-        add_color(mixed, m_config.ka_right_color);
-        triggered = true;
+}
+
+void StatusLed::update() {
+    const uint32_t now_us = time_us_32();
+
+    updatePads(now_us);
+
+    if ((now_us - m_last_frame_us) < m_frame_interval_us) {
+        return;
     }
+    // Keep a steady frame rate, but don't try to catch up on frames missed e.g. while signing PS4 challenges.
+    m_last_frame_us =
+        (now_us - m_last_frame_us) < 2 * m_frame_interval_us ? m_last_frame_us + m_frame_interval_us : now_us;
+
+    render(now_us);
 
-    if (triggered) {
-        ws2812_put_pixel(
-            pio0, ws2812_rgb_to_gamma_corrected_u32pixel(static_cast<uint8_t>((float)mixed.r * brightness_factor),
-                                                         static_cast<uint8_t>((float)mixed.g * brightness_factor),
-                                                         static_cast<uint8_t>((float)mixed.b * brightness_factor)));
-    } else {
-        const auto idle_color =
-            m_config.enable_player_color ? m_player_color.value_or(m_config.idle_color) : m_config.idle_color;
-
-        ws2812_put_pixel(pio0, ws2812_rgb_to_gamma_corrected_u32pixel(
-                                   static_cast<uint8_t>((float)idle_color.r * brightness_factor),
-                                   static_cast<uint8_t>((float)idle_color.g * brightness_factor),
-                                   static_cast<uint8_t>((float)idle_color.b * brightness_factor)));
+    // Only push changed frames, a frame which can't be sent yet is retried on the next frame.
+    if (m_frame_pending && ws2812_put_frame_async(pio0, m_frame.data(), m_frame.size())) {
+        m_frame_pending = false;
     }
+
+    m_frame_time.record(time_us_32() - now_us);
+}
+
+bool StatusLed::isNonBlocking() const { return ws2812_has_dma(); }
+
+Utils::TimingStats StatusLed::takeFrameTime() {
+    const auto stats = m_frame_time;
+    m_frame_time.reset();
+    return stats;
 }
 
 } // namespace Doncon::Peripherals
\ No newline at end of file
@@ -42,6 +42,7 @@ typedef struct {
     ps4_auth_challenge_response_t challenge_response;
     uint8_t challenge_response_read_seq;
     bool challenge_response_ready;
+    uint32_t sign_request;
 } ps4_auth_state_t;
 
 static ps4_auth_sign_cb_t ps4_auth_sign_cb = NULL;
@@ -110,6 +111,8 @@ void ps4_auth_init(const char *private_key, size_t private_key_len, const uint8_
 }
 
 void ps4_auth_reset() {
+    // A signature still being computed belongs to the previous challenge and must not be reported for a new one.
+    auth_state.sign_request++;
     auth_state.challenge_id = 0;
     auth_state.challenge_response_read_seq = 0;
     auth_state.challenge_response_ready = false;
@@ -152,7 +155,7 @@ void ps4_auth_set_challenge_report(uint8_t report_id, uint8_t const *buffer, uin
 
     if (sizeof(auth_state.challenge_data) - offset < sizeof(report.challenge_data)) {
         if (ps4_auth_sign_cb) {
-            ps4_auth_sign_cb(auth_state.challenge_data);
+            ps4_auth_sign_cb(auth_state.challenge_data, auth_state.sign_request);
         }
     }
 }
@@ -215,7 +218,11 @@ uint16_t ps4_auth_get_reset_report(uint8_t report_id, uint8_t *buffer) {
     return sizeof(ps4_0xf3_report);
 }
 
-void ps4_auth_set_signed_challenge(const uint8_t singed_challenge[PS4_AUTH_CHALLENGE_LENGTH]) {
+void ps4_auth_set_signed_challenge(const uint8_t singed_challenge[PS4_AUTH_CHALLENGE_LENGTH], uint32_t request) {
+    if (request != auth_state.sign_request) {
+        return;
+    }
+
     memcpy(auth_state.challenge_response.signature, singed_challenge, sizeof(auth_state.challenge_response.signature));
 
     auth_state.challenge_response_ready = true;
@@ -2,11 +2,13 @@
 
 #include "usb/device/hid/keyboard_driver.h"
 #include "usb/device/hid/ps3_driver.h"
+#include "usb/device/hid/ps4_auth.h"
 #include "usb/device/hid/ps4_driver.h"
 #include "usb/device/hid/switch_driver.h"
 #include "usb/device/midi_driver.h"
 #include "usb/device/vendor/debug_driver.h"
 #include "usb/device/vendor/xinput_driver.h"
+#include "utils/HotPath.h"
 
 #include "bsp/board.h"
 #include "pico/unique_id.h"
@@ -16,12 +18,16 @@
 
 enum {
     DESC_STR_MAX = 127,
+    RECONNECT_DELAY_MS = 100, // Long enough for the host to register the disconnect
 };
 
 static usb_mode_t usbd_mode = USB_MODE_DEBUG;
 static const usbd_driver_t *usbd_driver = NULL;
 static usbd_player_led_cb_t usbd_player_led_cb = NULL;
 
+static bool usbd_reconnect_pending = false;
+static absolute_time_t usbd_reconnect_time;
+
 #define USBD_SERIAL_STR_SIZE (PICO_UNIQUE_BOARD_ID_SIZE_BYTES * 2 + 1 + 3)
 static char usbd_serial_str[USBD_SERIAL_STR_SIZE] = {};
 static char usbd_product_str[DESC_STR_MAX] = {};
@@ -32,7 +38,7 @@ char *const usbd_desc_str[] = {
     [USBD_STR_SERIAL] = usbd_serial_str,         //
 };
 
-void usbd_driver_init(usb_mode_t mode) {
+static void usbd_driver_select(usb_mode_t mode) {
     usbd_mode = mode;
 
     switch (mode) {
@@ -66,31 +72,79 @@ void usbd_driver_init(usb_mode_t mode) {
     case USB_MODE_DEBUG:
         usbd_driver = get_debug_device_driver();
         break;
+    case USB_MODE_CAPTURE:
+        usbd_driver = get_capture_device_driver();
+        break;
     }
 
+    // Descriptor strings depend on the mode and are rebuilt on the next request
+    usbd_serial_str[0] = '\0';
+    usbd_product_str[0] = '\0';
+}
+
+void usbd_driver_init(usb_mode_t mode) {
+    usbd_driver_select(mode);
+
     tud_init(BOARD_TUD_RHPORT);
 }
 
-void usbd_driver_task() { tud_task(); }
+void usbd_driver_switch_mode(usb_mode_t mode) {
+    if (mode == usbd_mode) {
+        return;
+    }
+
+    // TinyUSB queries the application class driver only once during init, so the stack needs
+    // to be torn down completely. It is brought up again by usbd_driver_task() after the host
+    // had time to notice the disconnect, which then enumerates the device in the new mode.
+    tud_disconnect();
+    tud_deinit(BOARD_TUD_RHPORT);
+
+    usbd_driver_select(mode);
+    ps4_auth_reset();
+
+    usbd_reconnect_time = make_timeout_time_ms(RECONNECT_DELAY_MS);
+    usbd_reconnect_pending = true;
+}
+
+void usbd_driver_task() {
+    if (usbd_reconnect_pending) {
+        if (!time_reached(usbd_reconnect_time)) {
+            return;
+        }
+        usbd_reconnect_pending = false;
+        tud_init(BOARD_TUD_RHPORT);
+    }
+
+    tud_task();
+}
 
 usb_mode_t usbd_driver_get_mode() { return usbd_mode; }
 
-void usbd_driver_send_report(usb_report_t report) {
-    static const uint64_t interval_us = 900;
-    static uint64_t start_us = 0;
+bool usbd_driver_is_host_active() { return !usbd_reconnect_pending && tud_mounted() && !tud_suspended(); }
 
-    if (to_us_since_boot(get_absolute_time()) - start_us <= interval_us) {
-        return;
+bool HOT_PATH_FUNC(usbd_driver_send_report)(usb_report_t report) {
+    static const uint32_t interval_us = 900;
+    static uint32_t start_us = 0;
+
+    // time_us_32() only reads the timer register, time_us_64() would call into flash.
+    if (time_us_32() - start_us <= interval_us) {
+        return false;
     }
     start_us += interval_us;
 
+    if (usbd_reconnect_pending) {
+        return false;
+    }
+
     if (tud_suspended()) {
         tud_remote_wakeup();
     }
 
     if (usbd_driver->send_report) {
-        usbd_driver->send_report(report);
+        return usbd_driver->send_report(report);
     }
+
+    return false;
 }
 
 void usbd_driver_set_player_led_cb(usbd_player_led_cb_t cb) { usbd_player_led_cb = cb; };
@@ -0,0 +1,62 @@
+#include "utils/CaptureReport.h"
+
+#include <algorithm>
+#include <numeric>
+#include <span>
+
+namespace Doncon::Utils {
+
+void CaptureReport::setEnabled(const bool enabled) {
+    m_pending = false;
+    m_last_dropped = Mcp3204Dma::get_dropped_samples();
+
+    Mcp3204Dma::set_capture_enabled(enabled);
+}
+
+void CaptureReport::buildFrame() {
+    const auto count = Mcp3204Dma::take_samples(m_sample_buffer);
+
+    if (count == 0) {
+        m_frame_size = 0;
+        return;
+    }
+
+    const auto base_timestamp = m_sample_buffer[0].timestamp_us;
+
+    for (size_t idx = 0; idx < count; ++idx) {
+        const auto &sample = m_sample_buffer[idx];
+
+        m_frame.samples[idx] = {
+            .offset_us = static_cast<uint16_t>(std::min<uint32_t>(sample.timestamp_us - base_timestamp, UINT16_MAX)),
+            .value = static_cast<uint16_t>((sample.channel << 14) | (sample.value & 0x0FFF)),
+        };
+    }
+
+    const uint32_t dropped = Mcp3204Dma::get_dropped_samples();
+
+    m_frame.header.sync = SYNC_WORD;
+    m_frame.header.sequence++;
+    m_frame.header.timestamp_us = base_timestamp;
+    m_frame.header.dropped = static_cast<uint16_t>(std::min<uint32_t>(dropped - m_last_dropped, UINT16_MAX));
+    m_frame.header.count = static_cast<uint8_t>(count);
+    m_frame.header.checksum = 0;
+
+    m_last_dropped = dropped;
+    m_frame_size = sizeof(Header) + (count * sizeof(Sample));
+
+    const std::span<const uint8_t> frame_bytes(reinterpret_cast<const uint8_t *>(&m_frame), m_frame_size);
+    m_frame.header.checksum = std::accumulate(frame_bytes.begin(), frame_bytes.end(), uint8_t(0));
+}
+
+usb_report_t CaptureReport::getReport() {
+    if (!m_pending) {
+        buildFrame();
+        m_pending = true;
+    }
+
+    return {reinterpret_cast<uint8_t *>(&m_frame), m_frame_size};
+}
+
+void CaptureReport::confirm() { m_pending = false; }
+
+} // namespace Doncon::Utils
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "utils/DrumScope.h"
+
+#include "utils/HotPath.h"
+
+#include "pico/time.h"
+
+#include <algorithm>
+
+namespace Doncon::Utils {
+
+void HOT_PATH_FUNC(DrumScope::add)(const InputState::Drum &drum) {
+    for (size_t idx = 0; idx < m_pending.raw.size(); ++idx) {
+        m_pending.raw[idx] = std::max(m_pending.raw[idx], drum.raw[idx]);
+    }
+    m_pending.triggered |= drum.triggered;
+
+    const uint32_t now = time_us_32();
+    if ((now - m_pending_start_us) >= SAMPLE_INTERVAL_US) {
+        // Nothing to do if core 1 is busy, e.g. signing a PS4 challenge, the scope just misses some samples.
+        m_ring.push(m_pending);
+
+        m_pending = {};
+        m_pending_start_us = now;
+    }
+}
+
+} // namespace Doncon::Utils
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "utils/InputRemap.h"
+
+namespace Doncon::Utils {
+
+bool InputRemap::isValid(const Mapping &mapping) {
+    uint32_t seen = 0;
+
+    for (const auto input : mapping) {
+        const auto index = static_cast<uint8_t>(input);
+        if (index >= InputState::INPUT_COUNT) {
+            return false;
+        }
+        seen |= (1U << index);
+    }
+
+    return seen == ((1U << InputState::INPUT_COUNT) - 1);
+}
+
+void InputRemap::setMapping(const Mapping &mapping) {
+    // Settings are reapplied on every change while the menu is open, only rebuild the tables if needed.
+    if (mapping == m_mapping) {
+        return;
+    }
+    m_mapping = mapping;
+
+    if (!isValid(mapping) || mapping == identity()) {
+        m_is_identity = true;
+        return;
+    }
+
+    // One table per input byte, each entry holds the remapped bits for that byte value.
+    for (size_t lut = 0; lut < LUT_COUNT; ++lut) {
+        for (uint32_t value = 0; value < 256; ++value) {
+            uint32_t remapped = 0;
+            for (size_t bit = 0; bit < 8; ++bit) {
+                const size_t input = (lut * 8) + bit;
+                if (input < InputState::INPUT_COUNT && (value & (1U << bit))) {
+                    remapped |= 1U << static_cast<uint8_t>(mapping[input]);
+                }
+            }
+            m_luts[lut][value] = remapped;
+        }
+    }
+
+    m_pad_sources.fill(InputState::PAD_COUNT);
+    for (size_t pad = 0; pad < InputState::PAD_COUNT; ++pad) {
+        const auto target = static_cast<size_t>(mapping[pad]);
+        if (target < InputState::PAD_COUNT) {
+            m_pad_sources[target] = static_cast<uint8_t>(pad);
+        }
+    }
+
+    m_is_identity = false;
+}
+
+} // namespace Doncon::Utils
\ No newline at end of file
@@ -1,121 +1,246 @@
 #include "utils/InputReport.h"
 
-#include <iomanip>
-#include <sstream>
+#include "utils/HotPath.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
 
 namespace Doncon::Utils {
 
 namespace {
 
-uint8_t getHidHat(const InputState::Controller::DPad dpad) {
-    if (dpad.up && dpad.right) {
+using Input = InputState::Input;
+
+// Maps a digital input to a bit within a report field.
+struct BitMapping {
+    Input input;
+    uint8_t bit;
+};
+
+// Maps a digital input to a NKRO keyboard keycode.
+struct KeyMapping {
+    Input input;
+    uint8_t keycode;
+};
+
+constexpr uint32_t inputBit(const uint32_t digital, const Input input) {
+    return (digital >> static_cast<uint8_t>(input)) & 0x1U;
+}
+
+// Packs all inputs of the mapping into a bitfield, the mapping is expanded at compile time
+// into a branchless sequence of shifts and masks.
+template <const auto &TMapping> constexpr uint32_t pack(const uint32_t digital) {
+    return [digital]<size_t... I>(std::index_sequence<I...>) {
+        return (0U | ... | (inputBit(digital, TMapping[I].input) << TMapping[I].bit));
+    }(std::make_index_sequence<TMapping.size()>());
+}
+
+template <const auto &TMapping> constexpr void packKeys(const uint32_t digital, uint8_t (&keycodes)[32]) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ((keycodes[TMapping[I].keycode / 8] |= inputBit(digital, TMapping[I].input) << (TMapping[I].keycode % 8)),
+         ...);
+    }(std::make_index_sequence<TMapping.size()>());
+}
+
+// 0xFF if the input is set, 0x00 otherwise.
+constexpr uint8_t fill(const uint32_t digital, const Input input) {
+    return static_cast<uint8_t>(0U - inputBit(digital, input));
+}
+
+constexpr uint8_t getHidHat(const bool up, const bool down, const bool left, const bool right) {
+    if (up && right) {
         return 0x01;
     }
-    if (dpad.down && dpad.right) {
+    if (down && right) {
         return 0x03;
     }
-    if (dpad.down && dpad.left) {
+    if (down && left) {
         return 0x05;
     }
-    if (dpad.up && dpad.left) {
+    if (up && left) {
         return 0x07;
     }
-    if (dpad.up) {
+    if (up) {
         return 0x00;
     }
-    if (dpad.right) {
+    if (right) {
         return 0x02;
     }
-    if (dpad.down) {
+    if (down) {
         return 0x04;
     }
-    if (dpad.left) {
+    if (left) {
         return 0x06;
     }
 
     return 0x08;
 }
 
+static_assert(static_cast<uint8_t>(Input::Down) == static_cast<uint8_t>(Input::Up) + 1 &&
+                  static_cast<uint8_t>(Input::Left) == static_cast<uint8_t>(Input::Up) + 2 &&
+                  static_cast<uint8_t>(Input::Right) == static_cast<uint8_t>(Input::Up) + 3,
+              "Hat lookup requires consecutive dpad inputs");
+
+HOT_PATH_RODATA constexpr auto hid_hat_lut = [] {
+    std::array<uint8_t, 16> lut{};
+    for (size_t i = 0; i < lut.size(); ++i) {
+        lut[i] = getHidHat((i & 0x1) != 0, (i & 0x2) != 0, (i & 0x4) != 0, (i & 0x8) != 0);
+    }
+    return lut;
+}();
+
+uint8_t getHidHat(const uint32_t digital) { return hid_hat_lut[(digital >> static_cast<uint8_t>(Input::Up)) & 0xF]; }
+
+namespace Mapping {
+
+constexpr std::array switch_buttons = {
+    BitMapping{Input::West, 0},      // Y
+    BitMapping{Input::South, 1},     // B
+    BitMapping{Input::East, 2},      // A
+    BitMapping{Input::North, 3},     // X
+    BitMapping{Input::L, 4},         // L
+    BitMapping{Input::R, 5},         // R
+    BitMapping{Input::KaLeft, 6},    // ZL
+    BitMapping{Input::KaRight, 7},   // ZR
+    BitMapping{Input::Select, 8},    // -
+    BitMapping{Input::Start, 9},     // +
+    BitMapping{Input::DonLeft, 10},  // LS
+    BitMapping{Input::DonRight, 11}, // RS
+    BitMapping{Input::Home, 12},     // Home
+    BitMapping{Input::Share, 13},    // Capture
+};
+
+constexpr std::array ps3_buttons1 = {
+    BitMapping{Input::Select, 0},   // Select
+    BitMapping{Input::DonLeft, 1},  // L3
+    BitMapping{Input::DonRight, 2}, // R3
+    BitMapping{Input::Start, 3},    // Start
+    BitMapping{Input::Up, 4},       // Up
+    BitMapping{Input::Right, 5},    // Right
+    BitMapping{Input::Down, 6},     // Down
+    BitMapping{Input::Left, 7},     // Left
+};
+constexpr std::array ps3_buttons2 = {
+    BitMapping{Input::KaLeft, 0},  // L2
+    BitMapping{Input::KaRight, 1}, // R2
+    BitMapping{Input::L, 2},       // L1
+    BitMapping{Input::R, 3},       // R1
+    BitMapping{Input::North, 4},   // Triangle
+    BitMapping{Input::East, 5},    // Circle
+    BitMapping{Input::South, 6},   // Cross
+    BitMapping{Input::West, 7},    // Square
+};
+constexpr std::array ps3_buttons3 = {
+    BitMapping{Input::Home, 0}, // Home
+};
+
+constexpr std::array ps4_buttons1 = {
+    BitMapping{Input::West, 4},  // Square
+    BitMapping{Input::South, 5}, // Cross
+    BitMapping{Input::East, 6},  // Circle
+    BitMapping{Input::North, 7}, // Triangle
+};
+constexpr std::array ps4_buttons2 = {
+    BitMapping{Input::L, 0},        // L1
+    BitMapping{Input::R, 1},        // R1
+    BitMapping{Input::KaLeft, 2},   // L2
+    BitMapping{Input::KaRight, 3},  // R2
+    BitMapping{Input::Share, 4},    // Share
+    BitMapping{Input::Start, 5},    // Option
+    BitMapping{Input::DonLeft, 6},  // L3
+    BitMapping{Input::DonRight, 7}, // R3
+};
+constexpr std::array ps4_buttons3 = {
+    BitMapping{Input::Home, 0},   // PS
+    BitMapping{Input::Select, 1}, // T-Pad
+};
+
+constexpr std::array keyboard_common = {
+    KeyMapping{Input::Up, HID_KEY_ARROW_UP},
+    KeyMapping{Input::Down, HID_KEY_ARROW_DOWN},
+    KeyMapping{Input::Left, HID_KEY_ARROW_LEFT},
+    KeyMapping{Input::Right, HID_KEY_ARROW_RIGHT},
+    KeyMapping{Input::North, HID_KEY_L},
+    KeyMapping{Input::East, HID_KEY_BACKSPACE},
+    KeyMapping{Input::South, HID_KEY_ENTER},
+    KeyMapping{Input::West, HID_KEY_P},
+    KeyMapping{Input::L, HID_KEY_Q},
+    KeyMapping{Input::R, HID_KEY_E},
+    KeyMapping{Input::Start, HID_KEY_ESCAPE},
+    KeyMapping{Input::Select, HID_KEY_TAB},
+    // Home and Share are not mapped
+};
+constexpr std::array keyboard_drum_p1 = {
+    KeyMapping{Input::KaLeft, HID_KEY_D},
+    KeyMapping{Input::DonLeft, HID_KEY_F},
+    KeyMapping{Input::DonRight, HID_KEY_J},
+    KeyMapping{Input::KaRight, HID_KEY_K},
+};
+constexpr std::array keyboard_drum_p2 = {
+    KeyMapping{Input::KaLeft, HID_KEY_C},
+    KeyMapping{Input::DonLeft, HID_KEY_B},
+    KeyMapping{Input::DonRight, HID_KEY_N},
+    KeyMapping{Input::KaRight, HID_KEY_COMMA},
+};
+
+constexpr std::array xinput_buttons1 = {
+    BitMapping{Input::Up, 0},     // Dpad Up
+    BitMapping{Input::Down, 1},   // Dpad Down
+    BitMapping{Input::Left, 2},   // Dpad Left
+    BitMapping{Input::Right, 3},  // Dpad Right
+    BitMapping{Input::Start, 4},  // Start
+    BitMapping{Input::Select, 5}, // Select
+};
+constexpr std::array xinput_buttons2 = {
+    BitMapping{Input::L, 0},     // L1
+    BitMapping{Input::R, 1},     // R1
+    BitMapping{Input::Home, 2},  // Guide
+    BitMapping{Input::South, 4}, // A
+    BitMapping{Input::East, 5},  // B
+    BitMapping{Input::West, 6},  // X
+    BitMapping{Input::North, 7}, // Y
+};
+constexpr std::array xinput_drum_buttons1 = {
+    BitMapping{Input::DonLeft, 1}, // Dpad Down
+    BitMapping{Input::KaLeft, 2},  // Dpad Left
+};
+constexpr std::array xinput_drum_buttons2 = {
+    BitMapping{Input::DonRight, 4}, // A
+    BitMapping{Input::KaRight, 5},  // B
+};
+
+} // namespace Mapping
+
 } // namespace
 
-usb_report_t InputReport::getSwitchReport(const InputState &state) {
-    const auto &controller = state.controller;
-    const auto &drum = state.drum;
-
-    m_switch_report.buttons = 0                                             //
-                              | (controller.buttons.west ? (1 << 0) : 0)    // Y
-                              | (controller.buttons.south ? (1 << 1) : 0)   // B
-                              | (controller.buttons.east ? (1 << 2) : 0)    // A
-                              | (controller.buttons.north ? (1 << 3) : 0)   // X
-                              | (controller.buttons.l ? (1 << 4) : 0)       // L
-                              | (controller.buttons.r ? (1 << 5) : 0)       // R
-                              | (drum.ka_left.triggered ? (1 << 6) : 0)     // ZL
-                              | (drum.ka_right.triggered ? (1 << 7) : 0)    // ZR
-                              | (controller.buttons.select ? (1 << 8) : 0)  // -
-                              | (controller.buttons.start ? (1 << 9) : 0)   // +
-                              | (drum.don_left.triggered ? (1 << 10) : 0)   // LS
-                              | (drum.don_right.triggered ? (1 << 11) : 0)  // RS
-                              | (controller.buttons.home ? (1 << 12) : 0)   // Home
-                              | (controller.buttons.share ? (1 << 13) : 0); // Capture
-
-    m_switch_report.hat = getHidHat(controller.dpad);
+void InputReport::setInputRemap(const InputRemap::Mapping &mapping) { m_input_remap.setMapping(mapping); }
+
+usb_report_t HOT_PATH_FUNC(InputReport::getSwitchReport)(const uint32_t digital) {
+    m_switch_report.buttons = pack<Mapping::switch_buttons>(digital);
+    m_switch_report.hat = getHidHat(digital);
 
     return {reinterpret_cast<uint8_t *>(&m_switch_report), sizeof(hid_switch_report_t)};
 }
 
-usb_report_t InputReport::getPS3Report(const InputState &state) {
-    const auto &controller = state.controller;
-    const auto &drum = state.drum;
-
-    m_ps3_report.buttons1 = 0                                             //
-                            | (controller.buttons.select ? (1 << 0) : 0)  // Select
-                            | (drum.don_left.triggered ? (1 << 1) : 0)    // L3
-                            | (drum.don_right.triggered ? (1 << 2) : 0)   // R3
-                            | (controller.buttons.start ? (1 << 3) : 0)   // Start
-                            | (controller.dpad.up ? (1 << 4) : 0)         // Up
-                            | (controller.dpad.right ? (1 << 5) : 0)      // Right
-                            | (controller.dpad.down ? (1 << 6) : 0)       // Down
-                            | (controller.dpad.left ? (1 << 7) : 0);      // Left
-    m_ps3_report.buttons2 = 0 | (drum.ka_left.triggered ? (1 << 0) : 0)   // L2
-                            | (drum.ka_right.triggered ? (1 << 1) : 0)    // R2
-                            | (controller.buttons.l ? (1 << 2) : 0)       // L1
-                            | (controller.buttons.r ? (1 << 3) : 0)       // R1
-                            | (controller.buttons.north ? (1 << 4) : 0)   // Triangle
-                            | (controller.buttons.east ? (1 << 5) : 0)    // Circle
-                            | (controller.buttons.south ? (1 << 6) : 0)   // Cross
-                            | (controller.buttons.west ? (1 << 7) : 0);   // Square
-    m_ps3_report.buttons3 = 0 | (controller.buttons.home ? (1 << 0) : 0); // Home
-
-    m_ps3_report.lt = (drum.ka_left.triggered ? 0xff : 0);
-    m_ps3_report.rt = (drum.ka_right.triggered ? 0xff : 0);
+usb_report_t HOT_PATH_FUNC(InputReport::getPS3Report)(const uint32_t digital) {
+    m_ps3_report.buttons1 = pack<Mapping::ps3_buttons1>(digital);
+    m_ps3_report.buttons2 = pack<Mapping::ps3_buttons2>(digital);
+    m_ps3_report.buttons3 = pack<Mapping::ps3_buttons3>(digital);
+
+    m_ps3_report.lt = fill(digital, Input::KaLeft);
+    m_ps3_report.rt = fill(digital, Input::KaRight);
 
     return {reinterpret_cast<uint8_t *>(&m_ps3_report), sizeof(hid_ps3_report_t)};
 }
 
-usb_report_t InputReport::getPS4Report(const InputState &state) {
-    const auto &controller = state.controller;
-    const auto &drum = state.drum;
-
-    m_ps4_report.buttons1 = getHidHat(controller.dpad)                    //
-                            | (controller.buttons.west ? (1 << 4) : 0)    // Square
-                            | (controller.buttons.south ? (1 << 5) : 0)   // Cross
-                            | (controller.buttons.east ? (1 << 6) : 0)    // Circle
-                            | (controller.buttons.north ? (1 << 7) : 0);  // Triangle
-    m_ps4_report.buttons2 = 0                                             //
-                            | (controller.buttons.l ? (1 << 0) : 0)       // L1
-                            | (controller.buttons.r ? (1 << 1) : 0)       // R1
-                            | (drum.ka_left.triggered ? (1 << 2) : 0)     // L2
-                            | (drum.ka_right.triggered ? (1 << 3) : 0)    // R2
-                            | (controller.buttons.share ? (1 << 4) : 0)   // Share
-                            | (controller.buttons.start ? (1 << 5) : 0)   // Option
-                            | (drum.don_left.triggered ? (1 << 6) : 0)    // L3
-                            | (drum.don_right.triggered ? (1 << 7) : 0);  // R3
-    m_ps4_report.buttons3 = (m_ps4_report_counter << 2)                   //
-                            | (controller.buttons.home ? (1 << 0) : 0)    // PS
-                            | (controller.buttons.select ? (1 << 1) : 0); // T-Pad
-
-    m_ps4_report.lt = (drum.ka_left.triggered ? 0xFF : 0);
-    m_ps4_report.rt = (drum.ka_right.triggered ? 0xFF : 0);
+usb_report_t HOT_PATH_FUNC(InputReport::getPS4Report)(const uint32_t digital) {
+    m_ps4_report.buttons1 = getHidHat(digital) | pack<Mapping::ps4_buttons1>(digital);
+    m_ps4_report.buttons2 = pack<Mapping::ps4_buttons2>(digital);
+    m_ps4_report.buttons3 = (m_ps4_report_counter << 2) | pack<Mapping::ps4_buttons3>(digital);
+
+    m_ps4_report.lt = fill(digital, Input::KaLeft);
+    m_ps4_report.rt = fill(digital, Input::KaRight);
 
     // This method actually gets called more often than the report is sent,
     // so counters are not consecutive ... let's see if this turns out to
@@ -127,112 +252,58 @@ usb_report_t InputReport::getPS4Report(const InputState &state) {
     return {reinterpret_cast<uint8_t *>(&m_ps4_report), sizeof(hid_ps4_report_t)};
 }
 
-usb_report_t InputReport::getKeyboardReport(const InputState &state, InputReport::Player player) {
-    const auto &controller = state.controller;
-    const auto &drum = state.drum;
-
+usb_report_t HOT_PATH_FUNC(InputReport::getKeyboardReport)(const uint32_t digital,
+                                                            InputReport::Player player) {
     m_keyboard_report = {};
 
-    auto set_key = [&](const bool input, const uint8_t keycode) {
-        if (input) {
-            m_keyboard_report.keycodes[keycode / 8] |= 1 << (keycode % 8);
-        }
-    };
-
     switch (player) {
-    case Player::One: {
-        set_key(drum.ka_left.triggered, HID_KEY_D);
-        set_key(drum.don_left.triggered, HID_KEY_F);
-        set_key(drum.don_right.triggered, HID_KEY_J);
-        set_key(drum.ka_right.triggered, HID_KEY_K);
-    } break;
-    case Player::Two: {
-        set_key(drum.ka_left.triggered, HID_KEY_C);
-        set_key(drum.don_left.triggered, HID_KEY_B);
-        set_key(drum.don_right.triggered, HID_KEY_N);
-        set_key(drum.ka_right.triggered, HID_KEY_COMMA);
-    } break;
+    case Player::One:
+        packKeys<Mapping::keyboard_drum_p1>(digital, m_keyboard_report.keycodes);
+        break;
+    case Player::Two:
+        packKeys<Mapping::keyboard_drum_p2>(digital, m_keyboard_report.keycodes);
+        break;
     }
-
-    set_key(controller.dpad.up, HID_KEY_ARROW_UP);
-    set_key(controller.dpad.down, HID_KEY_ARROW_DOWN);
-    set_key(controller.dpad.left, HID_KEY_ARROW_LEFT);
-    set_key(controller.dpad.right, HID_KEY_ARROW_RIGHT);
-
-    set_key(controller.buttons.north, HID_KEY_L);
-    set_key(controller.buttons.east, HID_KEY_BACKSPACE);
-    set_key(controller.buttons.south, HID_KEY_ENTER);
-    set_key(controller.buttons.west, HID_KEY_P);
-
-    set_key(controller.buttons.l, HID_KEY_Q);
-    set_key(controller.buttons.r, HID_KEY_E);
-
-    set_key(controller.buttons.start, HID_KEY_ESCAPE);
-    set_key(controller.buttons.select, HID_KEY_TAB);
-    // set_key(controller.buttons.home, );
-    // set_key(controller.buttons.share, );
+    packKeys<Mapping::keyboard_common>(digital, m_keyboard_report.keycodes);
 
     return {reinterpret_cast<uint8_t *>(&m_keyboard_report), sizeof(hid_nkro_keyboard_report_t)};
 }
 
-usb_report_t InputReport::getXinputBaseReport(const InputState &state) {
-    const auto &controller = state.controller;
-
-    m_xinput_report.buttons1 = 0                                            //
-                               | (controller.dpad.up ? (1 << 0) : 0)        // Dpad Up
-                               | (controller.dpad.down ? (1 << 1) : 0)      // Dpad Down
-                               | (controller.dpad.left ? (1 << 2) : 0)      // Dpad Left
-                               | (controller.dpad.right ? (1 << 3) : 0)     // Dpad Right
-                               | (controller.buttons.start ? (1 << 4) : 0)  // Start
-                               | (controller.buttons.select ? (1 << 5) : 0) // Select
-                               | (false ? (1 << 6) : 0)                     // L3
-                               | (false ? (1 << 7) : 0);                    // R3
-    m_xinput_report.buttons2 = 0                                            //
-                               | (controller.buttons.l ? (1 << 0) : 0)      // L1
-                               | (controller.buttons.r ? (1 << 1) : 0)      // R1
-                               | (controller.buttons.home ? (1 << 2) : 0)   // Guide
-                               | (controller.buttons.south ? (1 << 4) : 0)  // A
-                               | (controller.buttons.east ? (1 << 5) : 0)   // B
-                               | (controller.buttons.west ? (1 << 6) : 0)   // X
-                               | (controller.buttons.north ? (1 << 7) : 0); // Y
+usb_report_t HOT_PATH_FUNC(InputReport::getXinputBaseReport)(const uint32_t digital) {
+    m_xinput_report.buttons1 = pack<Mapping::xinput_buttons1>(digital);
+    m_xinput_report.buttons2 = pack<Mapping::xinput_buttons2>(digital);
 
     return {reinterpret_cast<uint8_t *>(&m_xinput_report), sizeof(xinput_report_t)};
 }
 
-usb_report_t InputReport::getXinputDigitalReport(const InputState &state) {
-    const auto &drum = state.drum;
-
-    getXinputBaseReport(state);
-
-    m_xinput_report.buttons1 |= (drum.don_left.triggered ? (1 << 1) : 0)   // Dpad Down
-                                | (drum.ka_left.triggered ? (1 << 2) : 0); // Dpad Left
+usb_report_t HOT_PATH_FUNC(InputReport::getXinputDigitalReport)(const uint32_t digital) {
+    getXinputBaseReport(digital);
 
-    m_xinput_report.buttons2 |= (drum.don_right.triggered ? (1 << 4) : 0)   // A
-                                | (drum.ka_right.triggered ? (1 << 5) : 0); // B
+    m_xinput_report.buttons1 |= pack<Mapping::xinput_drum_buttons1>(digital);
+    m_xinput_report.buttons2 |= pack<Mapping::xinput_drum_buttons2>(digital);
 
     return {reinterpret_cast<uint8_t *>(&m_xinput_report), sizeof(xinput_report_t)};
 }
 
-usb_report_t InputReport::getXinputAnalogReport(const InputState &state, InputReport::Player player) {
-    const auto &drum = state.drum;
-
-    getXinputBaseReport(state);
+usb_report_t HOT_PATH_FUNC(InputReport::getXinputAnalogReport)(const InputState::PadArray<uint16_t> &analog,
+                                                                const uint32_t digital, InputReport::Player player) {
+    getXinputBaseReport(digital);
 
     int16_t x = 0;
     int16_t y = 0;
 
     auto map_to_axis = [](uint16_t raw) { return (int16_t)(raw >> 1); };
 
-    if (drum.ka_left.analog > drum.don_left.analog) {
-        x = (int16_t)-map_to_axis(drum.ka_left.analog);
+    if (analog[Input::KaLeft] > analog[Input::DonLeft]) {
+        x = (int16_t)-map_to_axis(analog[Input::KaLeft]);
     } else {
-        x = map_to_axis(drum.don_left.analog);
+        x = map_to_axis(analog[Input::DonLeft]);
     }
 
-    if (drum.ka_right.analog > drum.don_right.analog) {
-        y = map_to_axis(drum.ka_right.analog);
+    if (analog[Input::KaRight] > analog[Input::DonRight]) {
+        y = map_to_axis(analog[Input::KaRight]);
     } else {
-        y = (int16_t)-map_to_axis(drum.don_right.analog);
+        y = (int16_t)-map_to_axis(analog[Input::DonRight]);
     }
 
     switch (player) {
@@ -249,78 +320,87 @@ usb_report_t InputReport::getXinputAnalogReport(const InputState &state, InputRe
     return {reinterpret_cast<uint8_t *>(&m_xinput_report), sizeof(xinput_report_t)};
 }
 
-usb_report_t InputReport::getMidiReport(const InputState &state) {
-    const auto &drum = state.drum;
-
-    m_midi_report.status.acoustic_bass_drum = drum.don_left.triggered;
-    m_midi_report.status.electric_bass_drum = drum.don_right.triggered;
-    m_midi_report.status.drumsticks = drum.ka_left.triggered;
-    m_midi_report.status.side_stick = drum.ka_right.triggered;
+usb_report_t HOT_PATH_FUNC(InputReport::getMidiReport)(const InputState::PadArray<uint16_t> &analog,
+                                                        const uint32_t digital) {
+    m_midi_report.status.acoustic_bass_drum = inputBit(digital, Input::DonLeft) != 0;
+    m_midi_report.status.electric_bass_drum = inputBit(digital, Input::DonRight) != 0;
+    m_midi_report.status.drumsticks = inputBit(digital, Input::KaLeft) != 0;
+    m_midi_report.status.side_stick = inputBit(digital, Input::KaRight) != 0;
 
     auto convert_range = [](uint16_t in) {
         const uint16_t out = in / 256;
         return uint8_t(out > 127 ? 127 : out);
     };
 
-    m_midi_report.velocity.acoustic_bass_drum = convert_range(drum.don_left.analog);
-    m_midi_report.velocity.electric_bass_drum = convert_range(drum.don_right.analog);
-    m_midi_report.velocity.drumsticks = convert_range(drum.ka_left.analog);
-    m_midi_report.velocity.side_stick = convert_range(drum.ka_right.analog);
+    m_midi_report.velocity.acoustic_bass_drum = convert_range(analog[Input::DonLeft]);
+    m_midi_report.velocity.electric_bass_drum = convert_range(analog[Input::DonRight]);
+    m_midi_report.velocity.drumsticks = convert_range(analog[Input::KaLeft]);
+    m_midi_report.velocity.side_stick = convert_range(analog[Input::KaRight]);
 
     return {reinterpret_cast<uint8_t *>(&m_midi_report), sizeof(midi_report_t)};
 }
 
-usb_report_t InputReport::getDebugReport(const InputState &state) {
-    const auto &drum = state.drum;
+usb_report_t InputReport::getDebugReport(const InputState::PadArray<uint16_t> &raw, const uint32_t digital) {
+    static constexpr uint32_t pad_mask = (1U << InputState::PAD_COUNT) - 1;
 
-    std::stringstream out;
+    m_debug_report.clear();
 
-    auto bar = [](uint16_t val) { return std::string(val / 511, '#'); };
+    auto append_pad = [&](const char *open, const char *close, const Input pad) {
+        const size_t bar_length = std::min<size_t>(raw[pad] / 511, 8);
 
-    if (drum.don_left.triggered || drum.ka_left.triggered || drum.don_right.triggered || drum.ka_right.triggered) {
-        out << "(" << (drum.ka_left.triggered ? "*" : " ") << "( "                                         //
-            << std::setw(4) << drum.ka_left.raw << "[" << std::setw(8) << bar(drum.ka_left.raw) << "]"     //
-            << "(" << (drum.don_left.triggered ? "*" : " ") << "| "                                        //
-            << std::setw(4) << drum.don_left.raw << "[" << std::setw(8) << bar(drum.don_left.raw) << "]"   //
-            << "|" << (drum.don_right.triggered ? "*" : " ") << ") "                                       //
-            << std::setw(4) << drum.don_right.raw << "[" << std::setw(8) << bar(drum.don_right.raw) << "]" //
-            << ")" << (drum.ka_right.triggered ? "*" : " ") << ") "                                        //
-            << std::setw(4) << drum.ka_right.raw << "[" << std::setw(8) << bar(drum.ka_right.raw) << "]"   //
-            << "\n";
-    }
+        m_debug_report.append(open)
+            .append(inputBit(digital, pad) != 0 ? '*' : ' ')
+            .append(close)
+            .append(static_cast<uint32_t>(raw[pad]), 4)
+            .append('[')
+            .append(' ', 8 - bar_length)
+            .append('#', bar_length)
+            .append(']');
+    };
 
-    m_debug_report = out.str();
+    if ((digital & pad_mask) != 0) {
+        append_pad("(", "( ", Input::KaLeft);
+        append_pad("(", "| ", Input::DonLeft);
+        append_pad("|", ") ", Input::DonRight);
+        append_pad(")", ") ", Input::KaRight);
+        m_debug_report.append('\n');
+    }
 
-    return {reinterpret_cast<uint8_t *>(m_debug_report.data()), static_cast<uint16_t>(m_debug_report.size() + 1)};
+    return {reinterpret_cast<uint8_t *>(m_debug_report.data()), static_cast<uint16_t>(m_debug_report.size())};
 }
 
-usb_report_t InputReport::getReport(const InputState &state, usb_mode_t mode) {
+usb_report_t HOT_PATH_FUNC(InputReport::getReport)(const InputState &state, usb_mode_t mode) {
+    const uint32_t digital = m_input_remap.apply(state.digital());
+
     switch (mode) {
     case USB_MODE_SWITCH_TATACON:
     case USB_MODE_SWITCH_HORIPAD:
-        return getSwitchReport(state);
+        return getSwitchReport(digital);
     case USB_MODE_DUALSHOCK3:
-        return getPS3Report(state);
+        return getPS3Report(digital);
     case USB_MODE_PS4_TATACON:
     case USB_MODE_DUALSHOCK4:
-        return getPS4Report(state);
+        return getPS4Report(digital);
     case USB_MODE_KEYBOARD_P1:
-        return getKeyboardReport(state, Player::One);
+        return getKeyboardReport(digital, Player::One);
     case USB_MODE_KEYBOARD_P2:
-        return getKeyboardReport(state, Player::Two);
+        return getKeyboardReport(digital, Player::Two);
     case USB_MODE_XBOX360:
-        return getXinputDigitalReport(state);
+        return getXinputDigitalReport(digital);
     case USB_MODE_XBOX360_ANALOG_P1:
-        return getXinputAnalogReport(state, Player::One);
+        return getXinputAnalogReport(m_input_remap.applyPads(state.drum.analog), digital, Player::One);
     case USB_MODE_XBOX360_ANALOG_P2:
-        return getXinputAnalogReport(state, Player::Two);
+        return getXinputAnalogReport(m_input_remap.applyPads(state.drum.analog), digital, Player::Two);
     case USB_MODE_MIDI:
-        return getMidiReport(state);
+        return getMidiReport(m_input_remap.applyPads(state.drum.analog), digital);
     case USB_MODE_DEBUG:
-        return getDebugReport(state);
+        return getDebugReport(m_input_remap.applyPads(state.drum.raw), digital);
+    case USB_MODE_CAPTURE:
+        // Raw sample frames are provided by CaptureReport instead
+        return {.data = nullptr, .size = 0};
     }
 
-    return getDebugReport(state);
+    return getDebugReport(m_input_remap.applyPads(state.drum.raw), digital);
 }
 
-} // namespace Doncon::Utils
+} // namespace Doncon::Utils
\ No newline at end of file
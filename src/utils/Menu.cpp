@@ -2,165 +2,220 @@
 
 #include "peripherals/Drum.h"
 
+#include "GlobalConfiguration.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
 namespace Doncon::Utils {
 
+namespace {
+
+using Page = Menu::Page;
+using Type = Menu::Descriptor::Type;
+using Action = Menu::Descriptor::Action;
+using Item = Menu::Descriptor::Item;
+
+// Selected item of a page whose selected_value is an index into its items. Values loaded from the settings, like
+// the usb mode or profile, might not match any item and fall back to the first one.
+uint16_t clamp_selection(const Menu::Descriptor &descriptor, const uint16_t value) {
+    switch (descriptor.type) {
+    case Type::Menu:
+    case Type::Selection:
+    case Type::Meter:
+    case Type::RebootInfo:
+        return value < descriptor.items.size() ? value : 0;
+    case Type::Value:
+    case Type::Toggle:
+        break;
+    }
+
+    return value;
+}
+
 // NOLINTBEGIN(modernize-use-designated-initializers)
-const std::map<Menu::Page, const Menu::Descriptor> Menu::descriptors = {
-    {Menu::Page::Main,                                            //
-     {Menu::Descriptor::Type::Menu,                               //
-      "Settings",                                                 //
-      {{"Mode", Menu::Descriptor::Action::GotoPageDeviceMode},    //
-       {"Drum", Menu::Descriptor::Action::GotoPageDrum},          //
-       {"Led", Menu::Descriptor::Action::GotoPageLed},            //
-       {"Reset", Menu::Descriptor::Action::GotoPageReset},        //
-       {"USB Flash", Menu::Descriptor::Action::GotoPageBootsel}}, //
-      0}},                                                        //
-
-    {Menu::Page::DeviceMode,                                 //
-     {Menu::Descriptor::Type::Selection,                     //
-      "Mode",                                                //
-      {{"Swtch Tata", Menu::Descriptor::Action::SetUsbMode}, //
-       {"Swtch Pro", Menu::Descriptor::Action::SetUsbMode},  //
-       {"Dualshock3", Menu::Descriptor::Action::SetUsbMode}, //
-       {"PS4 Tata", Menu::Descriptor::Action::SetUsbMode},   //
-       {"Dualshock4", Menu::Descriptor::Action::SetUsbMode}, //
-       {"Keybrd P1", Menu::Descriptor::Action::SetUsbMode},  //
-       {"Keybrd P2", Menu::Descriptor::Action::SetUsbMode},  //
-       {"Xbox 360", Menu::Descriptor::Action::SetUsbMode},   //
-       {"Analog P1", Menu::Descriptor::Action::SetUsbMode},  //
-       {"Analog P2", Menu::Descriptor::Action::SetUsbMode},  //
-       {"MIDI", Menu::Descriptor::Action::SetUsbMode},       //
-       {"Debug", Menu::Descriptor::Action::SetUsbMode}},     //
-      0}},                                                   //
-
-    {Menu::Page::Drum,                                                          //
-     {Menu::Descriptor::Type::Menu,                                             //
-      "Drum Settings",                                                          //
-      {{"Hold Time", Menu::Descriptor::Action::GotoPageDrumDebounceDelay},      //
-       {"Thresholds", Menu::Descriptor::Action::GotoPageDrumTriggerThresholds}, //
-       {"Double Trg", Menu::Descriptor::Action::GotoPageDrumDoubleTrigger}},    //
-      0}},                                                                      //
-
-    {Menu::Page::DrumTriggerThresholds,                                               //
-     {Menu::Descriptor::Type::Menu,                                                   //
-      "Thresholds",                                                                   //
-      {{"Left Ka", Menu::Descriptor::Action::GotoPageDrumTriggerThresholdKaLeft},     //
-       {"Left Don", Menu::Descriptor::Action::GotoPageDrumTriggerThresholdDonLeft},   //
-       {"Right Don", Menu::Descriptor::Action::GotoPageDrumTriggerThresholdDonRight}, //
-       {"Right Ka", Menu::Descriptor::Action::GotoPageDrumTriggerThresholdKaRight}},  //
-      0}},                                                                            //
-
-    {Menu::Page::DrumDoubleTrigger,                                                  //
-     {Menu::Descriptor::Type::Menu,                                                  //
-      "Double Hit Mode",                                                             //
-      {{"Off", Menu::Descriptor::Action::SetDoubleTriggerOff},                       //
-       {"Threshold", Menu::Descriptor::Action::GotoPageDrumDoubleTriggerThresholds}, //
-       {"Always", Menu::Descriptor::Action::SetDoubleTriggerAlways}},                //
-      0}},                                                                           //
-
-    {Menu::Page::DrumDoubleTriggerThresholds,                                               //
-     {Menu::Descriptor::Type::Menu,                                                         //
-      "Double Thresholds",                                                                  //
-      {{"Left Ka", Menu::Descriptor::Action::GotoPageDrumDoubleTriggerThresholdKaLeft},     //
-       {"Left Don", Menu::Descriptor::Action::GotoPageDrumDoubleTriggerThresholdDonLeft},   //
-       {"Right Don", Menu::Descriptor::Action::GotoPageDrumDoubleTriggerThresholdDonRight}, //
-       {"Right Ka", Menu::Descriptor::Action::GotoPageDrumDoubleTriggerThresholdKaRight}},  //
-      0}},
-
-    {Menu::Page::DrumDebounceDelay,                           //
-     {Menu::Descriptor::Type::Value,                          //
-      "Hit Hold Time (ms)",                                   //
-      {{"", Menu::Descriptor::Action::SetDrumDebounceDelay}}, //
-      UINT8_MAX}},
-
-    {Menu::Page::DrumTriggerThresholdKaLeft,                           //
-     {Menu::Descriptor::Type::Value,                                   //
-      "Trg Level Left Ka",                                             //
-      {{"", Menu::Descriptor::Action::SetDrumTriggerThresholdKaLeft}}, //
-      4095}},
-
-    {Menu::Page::DrumTriggerThresholdDonLeft,                           //
-     {Menu::Descriptor::Type::Value,                                    //
-      "Trg Level Left Don",                                             //
-      {{"", Menu::Descriptor::Action::SetDrumTriggerThresholdDonLeft}}, //
-      4095}},
-
-    {Menu::Page::DrumTriggerThresholdDonRight,                           //
-     {Menu::Descriptor::Type::Value,                                     //
-      "Trg Level Right Don",                                             //
-      {{"", Menu::Descriptor::Action::SetDrumTriggerThresholdDonRight}}, //
-      4095}},
-
-    {Menu::Page::DrumTriggerThresholdKaRight,                           //
-     {Menu::Descriptor::Type::Value,                                    //
-      "Trg Level Right Ka",                                             //
-      {{"", Menu::Descriptor::Action::SetDrumTriggerThresholdKaRight}}, //
-      4095}},
-
-    {Menu::Page::DrumDoubleTriggerThresholdKaLeft,                           //
-     {Menu::Descriptor::Type::Value,                                         //
-      "Trg Level Left Ka",                                                   //
-      {{"", Menu::Descriptor::Action::SetDrumDoubleTriggerThresholdKaLeft}}, //
-      4095}},
-
-    {Menu::Page::DrumDoubleTriggerThresholdDonLeft,                           //
-     {Menu::Descriptor::Type::Value,                                          //
-      "Trg Level Left Don",                                                   //
-      {{"", Menu::Descriptor::Action::SetDrumDoubleTriggerThresholdDonLeft}}, //
-      4095}},
-
-    {Menu::Page::DrumDoubleTriggerThresholdDonRight,                           //
-     {Menu::Descriptor::Type::Value,                                           //
-      "Trg Level Right Don",                                                   //
-      {{"", Menu::Descriptor::Action::SetDrumDoubleTriggerThresholdDonRight}}, //
-      4095}},
-
-    {Menu::Page::DrumDoubleTriggerThresholdKaRight,                           //
-     {Menu::Descriptor::Type::Value,                                          //
-      "Trg Level Right Ka",                                                   //
-      {{"", Menu::Descriptor::Action::SetDrumDoubleTriggerThresholdKaRight}}, //
-      4095}},
-
-    {Menu::Page::Led,                                                           //
-     {Menu::Descriptor::Type::Menu,                                             //
-      "LED Settings",                                                           //
-      {{"Brightness", Menu::Descriptor::Action::GotoPageLedBrightness},         //
-       {"Plyr Color", Menu::Descriptor::Action::GotoPageLedEnablePlayerColor}}, //
-      0}},                                                                      //
-
-    {Menu::Page::LedBrightness,                           //
-     {Menu::Descriptor::Type::Value,                      //
-      "LED Brightness",                                   //
-      {{"", Menu::Descriptor::Action::SetLedBrightness}}, //
-      UINT8_MAX}},                                        //
-
-    {Menu::Page::LedEnablePlayerColor,                           //
-     {Menu::Descriptor::Type::Toggle,                            //
-      "Player Color (PS4)",                                      //
-      {{"", Menu::Descriptor::Action::SetLedEnablePlayerColor}}, //
-      0}},                                                       //
-
-    {Menu::Page::Reset,                              //
-     {Menu::Descriptor::Type::Menu,                  //
-      "Reset all Settings?",                         //
-      {{"No", Menu::Descriptor::Action::GotoParent}, //
-       {"Yes", Menu::Descriptor::Action::DoReset}},  //
-      0}},                                           //
-
-    {Menu::Page::Bootsel,                                         //
-     {Menu::Descriptor::Type::Menu,                               //
-      "Reboot to Flash Mode",                                     //
-      {{"Reboot?", Menu::Descriptor::Action::DoRebootToBootsel}}, //
-      0}},                                                        //
-
-    {Menu::Page::BootselMsg,                         //
-     {Menu::Descriptor::Type::RebootInfo,            //
-      "Ready to Flash...",                           //
-      {{"BOOTSEL", Menu::Descriptor::Action::None}}, //
-      0}},                                           //
+constexpr Item main_items[] = {
+    {"Mode", Action::GotoPageDeviceMode},    //
+    {"Profile", Action::GotoPageProfile},    //
+    {"Drum", Action::GotoPageDrum},          //
+    {"Led", Action::GotoPageLed},            //
+    {"Buttons", Action::GotoPageInputRemap}, //
+    {"Reset", Action::GotoPageReset},        //
+    {"USB Flash", Action::GotoPageBootsel},
+};
+
+constexpr Item device_mode_items[] = {
+    {"Swtch Tata", Action::SetUsbMode}, //
+    {"Swtch Pro", Action::SetUsbMode},  //
+    {"Dualshock3", Action::SetUsbMode}, //
+    {"PS4 Tata", Action::SetUsbMode},   //
+    {"Dualshock4", Action::SetUsbMode}, //
+    {"Keybrd P1", Action::SetUsbMode},  //
+    {"Keybrd P2", Action::SetUsbMode},  //
+    {"Xbox 360", Action::SetUsbMode},   //
+    {"Analog P1", Action::SetUsbMode},  //
+    {"Analog P2", Action::SetUsbMode},  //
+    {"MIDI", Action::SetUsbMode},       //
+    {"Debug", Action::SetUsbMode},      //
+    {"Capture", Action::SetUsbMode},
+};
+
+constexpr auto profile_items = [] {
+    std::array<Item, Config::Default::profile_names.size()> items{};
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = {Config::Default::profile_names[i], Action::SetProfile};
+    }
+    return items;
+}();
+
+// Selectable button mappings, the first one is the default from GlobalConfiguration.h.
+constexpr auto input_remap_presets = [] {
+    using Input = InputState::Input;
+
+    const auto swapped = [](InputRemap::Mapping mapping, std::initializer_list<std::pair<Input, Input>> swaps) {
+        for (const auto &[a, b] : swaps) {
+            std::swap(mapping[static_cast<size_t>(a)], mapping[static_cast<size_t>(b)]);
+        }
+        return mapping;
+    };
+
+    return std::array<InputRemap::Mapping, 3>{
+        Config::Default::input_remap,
+        swapped(Config::Default::input_remap, {{Input::North, Input::West}, {Input::East, Input::South}}),
+        swapped(Config::Default::input_remap, {{Input::DonLeft, Input::DonRight}, {Input::KaLeft, Input::KaRight}}),
+    };
+}();
+
+constexpr Item input_remap_items[] = {
+    {"Default", Action::SetInputRemap},   //
+    {"Swap ABXY", Action::SetInputRemap}, //
+    {"Swap Drum", Action::SetInputRemap},
+};
+static_assert(std::size(input_remap_items) == input_remap_presets.size());
+
+constexpr Item drum_items[] = {
+    {"Hold Time", Action::GotoPageDrumDebounceDelay},
+    {"Thresholds", Action::GotoPageDrumTriggerThresholds},
+    {"Double Trg", Action::GotoPageDrumDoubleTrigger},
+    {"Live Meter", Action::GotoPageDrumSignalMeter},
+};
+
+constexpr Item drum_trigger_thresholds_items[] = {
+    {"Left Ka", Action::GotoPageDrumTriggerThresholdKaLeft},
+    {"Left Don", Action::GotoPageDrumTriggerThresholdDonLeft},
+    {"Right Don", Action::GotoPageDrumTriggerThresholdDonRight},
+    {"Right Ka", Action::GotoPageDrumTriggerThresholdKaRight},
+};
+
+constexpr Item drum_double_trigger_items[] = {
+    {"Off", Action::SetDoubleTriggerOff},
+    {"Threshold", Action::GotoPageDrumDoubleTriggerThresholds},
+    {"Always", Action::SetDoubleTriggerAlways},
+};
+
+constexpr Item drum_double_trigger_thresholds_items[] = {
+    {"Left Ka", Action::GotoPageDrumDoubleTriggerThresholdKaLeft},
+    {"Left Don", Action::GotoPageDrumDoubleTriggerThresholdDonLeft},
+    {"Right Don", Action::GotoPageDrumDoubleTriggerThresholdDonRight},
+    {"Right Ka", Action::GotoPageDrumDoubleTriggerThresholdKaRight},
 };
+
+// One bar per pad, in the same order as the trigger threshold pages.
+constexpr Item drum_signal_meter_items[] = {
+    {"L Ka", Action::SetDrumTriggerThresholdKaLeft},
+    {"L Don", Action::SetDrumTriggerThresholdDonLeft},
+    {"R Don", Action::SetDrumTriggerThresholdDonRight},
+    {"R Ka", Action::SetDrumTriggerThresholdKaRight},
+};
+
+constexpr Item drum_debounce_delay_items[] = {{"", Action::SetDrumDebounceDelay}};
+
+constexpr Item drum_trigger_threshold_ka_left_items[] = {{"", Action::SetDrumTriggerThresholdKaLeft}};
+constexpr Item drum_trigger_threshold_don_left_items[] = {{"", Action::SetDrumTriggerThresholdDonLeft}};
+constexpr Item drum_trigger_threshold_don_right_items[] = {{"", Action::SetDrumTriggerThresholdDonRight}};
+constexpr Item drum_trigger_threshold_ka_right_items[] = {{"", Action::SetDrumTriggerThresholdKaRight}};
+
+constexpr Item drum_double_trigger_threshold_ka_left_items[] = {{"", Action::SetDrumDoubleTriggerThresholdKaLeft}};
+constexpr Item drum_double_trigger_threshold_don_left_items[] = {{"", Action::SetDrumDoubleTriggerThresholdDonLeft}};
+constexpr Item drum_double_trigger_threshold_don_right_items[] = {{"", Action::SetDrumDoubleTriggerThresholdDonRight}};
+constexpr Item drum_double_trigger_threshold_ka_right_items[] = {{"", Action::SetDrumDoubleTriggerThresholdKaRight}};
+
+constexpr Item led_items[] = {
+    {"Brightness", Action::GotoPageLedBrightness},
+    {"Plyr Color", Action::GotoPageLedEnablePlayerColor},
+};
+
+constexpr Item led_brightness_items[] = {{"", Action::SetLedBrightness}};
+constexpr Item led_enable_player_color_items[] = {{"", Action::SetLedEnablePlayerColor}};
+
+constexpr Item reset_items[] = {
+    {"No", Action::GotoParent},
+    {"Yes", Action::DoReset},
+};
+
+constexpr Item bootsel_items[] = {{"Reboot?", Action::DoRebootToBootsel}};
+constexpr Item bootsel_msg_items[] = {{"BOOTSEL", Action::None}};
+
+constexpr std::array<Menu::Descriptor, Menu::PAGE_COUNT> make_descriptors() {
+    std::array<Menu::Descriptor, Menu::PAGE_COUNT> descriptors{};
+    const auto set = [&descriptors](Page page, const Menu::Descriptor &descriptor) {
+        descriptors[static_cast<size_t>(page)] = descriptor;
+    };
+
+    set(Page::Main, {Type::Menu, "Settings", main_items, 0});
+    set(Page::DeviceMode, {Type::Selection, "Mode", device_mode_items, 0});
+    set(Page::Profile, {Type::Selection, "Profile", profile_items, 0});
+    set(Page::Drum, {Type::Menu, "Drum Settings", drum_items, 0});
+    set(Page::Led, {Type::Menu, "LED Settings", led_items, 0});
+    set(Page::InputRemap, {Type::Selection, "Button Mapping", input_remap_items, 0});
+    set(Page::Reset, {Type::Menu, "Reset all Settings?", reset_items, 0});
+    set(Page::Bootsel, {Type::Menu, "Reboot to Flash Mode", bootsel_items, 0});
+
+    set(Page::DrumDebounceDelay, {Type::Value, "Hit Hold Time (ms)", drum_debounce_delay_items, UINT8_MAX});
+    set(Page::DrumTriggerThresholds, {Type::Menu, "Thresholds", drum_trigger_thresholds_items, 0});
+    set(Page::DrumDoubleTrigger, {Type::Menu, "Double Hit Mode", drum_double_trigger_items, 0});
+    set(Page::DrumSignalMeter, {Type::Meter, "Signal Meter", drum_signal_meter_items, 4095});
+
+    set(Page::DrumTriggerThresholdKaLeft,
+        {Type::Value, "Trg Level Left Ka", drum_trigger_threshold_ka_left_items, 4095});
+    set(Page::DrumTriggerThresholdDonLeft,
+        {Type::Value, "Trg Level Left Don", drum_trigger_threshold_don_left_items, 4095});
+    set(Page::DrumTriggerThresholdDonRight,
+        {Type::Value, "Trg Level Right Don", drum_trigger_threshold_don_right_items, 4095});
+    set(Page::DrumTriggerThresholdKaRight,
+        {Type::Value, "Trg Level Right Ka", drum_trigger_threshold_ka_right_items, 4095});
+
+    set(Page::DrumDoubleTriggerThresholds, {Type::Menu, "Double Thresholds", drum_double_trigger_thresholds_items, 0});
+
+    set(Page::DrumDoubleTriggerThresholdKaLeft,
+        {Type::Value, "Trg Level Left Ka", drum_double_trigger_threshold_ka_left_items, 4095});
+    set(Page::DrumDoubleTriggerThresholdDonLeft,
+        {Type::Value, "Trg Level Left Don", drum_double_trigger_threshold_don_left_items, 4095});
+    set(Page::DrumDoubleTriggerThresholdDonRight,
+        {Type::Value, "Trg Level Right Don", drum_double_trigger_threshold_don_right_items, 4095});
+    set(Page::DrumDoubleTriggerThresholdKaRight,
+        {Type::Value, "Trg Level Right Ka", drum_double_trigger_threshold_ka_right_items, 4095});
+
+    set(Page::LedBrightness, {Type::Value, "LED Brightness", led_brightness_items, UINT8_MAX});
+    set(Page::LedEnablePlayerColor, {Type::Toggle, "Player Color (PS4)", led_enable_player_color_items, 0});
+
+    set(Page::BootselMsg, {Type::RebootInfo, "Ready to Flash...", bootsel_msg_items, 0});
+
+    return descriptors;
+}
 // NOLINTEND(modernize-use-designated-initializers)
 
+// Every page needs a descriptor, the table is indexed by Page.
+static_assert(std::ranges::all_of(make_descriptors(), [](const auto &descriptor) {
+    return descriptor.name != nullptr && !descriptor.items.empty();
+}));
+
+} // namespace
+
+constinit const std::array<Menu::Descriptor, Menu::PAGE_COUNT> Menu::descriptors = make_descriptors();
+
 Menu::Buttons::Buttons()
     : m_states({{Id::Up, {}}, {Id::Down, {}}, {Id::Left, {}}, {Id::Right, {}}, {Id::Confirm, {}}, {Id::Back, {}}}) {}
 
@@ -215,16 +270,32 @@ void Menu::Buttons::update(const InputState::Controller &controller_state) {
         }
     };
 
-    handle_button(m_states.at(Id::Up), controller_state.dpad.up);
-    handle_button(m_states.at(Id::Down), controller_state.dpad.down);
-    handle_button(m_states.at(Id::Left), controller_state.dpad.left);
-    handle_button(m_states.at(Id::Right), controller_state.dpad.right);
-    handle_button(m_states.at(Id::Confirm), controller_state.buttons.east);
-    handle_button(m_states.at(Id::Back), controller_state.buttons.south);
+    using Input = InputState::Input;
+
+    handle_button(m_states.at(Id::Up), controller_state.isPressed(Input::Up));
+    handle_button(m_states.at(Id::Down), controller_state.isPressed(Input::Down));
+    handle_button(m_states.at(Id::Left), controller_state.isPressed(Input::Left));
+    handle_button(m_states.at(Id::Right), controller_state.isPressed(Input::Right));
+    handle_button(m_states.at(Id::Confirm), controller_state.isPressed(Input::East));
+    handle_button(m_states.at(Id::Back), controller_state.isPressed(Input::South));
 }
 
 bool Menu::Buttons::getPressed(Id id) const { return m_states.at(id).pressed; }
 
+uint16_t Menu::Buttons::getStep(Id id) const {
+    switch (m_states.at(id).repeat) {
+    case State::Repeat::Idle:
+    case State::Repeat::RepeatDelay:
+        return 1;
+    case State::Repeat::Repeat:
+        return 8;
+    case State::Repeat::FastRepeat:
+        return 32;
+    }
+
+    return 1;
+}
+
 Menu::Menu(std::shared_ptr<SettingsStore> settings_store) : m_store(std::move(settings_store)) {};
 
 void Menu::activate() {
@@ -236,6 +307,8 @@ uint16_t Menu::getCurrentValue(Menu::Page page) {
     switch (page) {
     case Page::DeviceMode:
         return static_cast<uint16_t>(m_store->getUsbMode());
+    case Page::Profile:
+        return m_store->getActiveProfile();
     case Page::DrumDebounceDelay:
         return m_store->getDebounceDelay();
     case Page::DrumDoubleTrigger:
@@ -260,10 +333,17 @@ uint16_t Menu::getCurrentValue(Menu::Page page) {
         return m_store->getLedBrightness();
     case Page::LedEnablePlayerColor:
         return static_cast<uint16_t>(m_store->getLedEnablePlayerColor());
+    case Page::InputRemap: {
+        const auto preset = std::ranges::find(input_remap_presets, m_store->getInputRemap());
+        return preset != input_remap_presets.end()
+                   ? static_cast<uint16_t>(std::distance(input_remap_presets.begin(), preset))
+                   : 0;
+    }
     case Page::Main:
     case Page::Drum:
     case Page::DrumTriggerThresholds:
     case Page::DrumDoubleTriggerThresholds:
+    case Page::DrumSignalMeter:
     case Page::Led:
     case Page::Reset:
     case Page::Bootsel:
@@ -277,7 +357,7 @@ uint16_t Menu::getCurrentValue(Menu::Page page) {
 void Menu::gotoPage(Menu::Page page) {
     const auto current_value = getCurrentValue(page);
 
-    m_state_stack.push({page, current_value, current_value});
+    m_state_stack.push({page, clamp_selection(getDescriptor(page), current_value), current_value});
 }
 
 void Menu::gotoParent(bool do_restore) {
@@ -292,6 +372,9 @@ void Menu::gotoParent(bool do_restore) {
         case Page::DeviceMode:
             m_store->setUsbMode(static_cast<usb_mode_t>(current_state.original_value));
             break;
+        case Page::Profile:
+            m_store->setActiveProfile(static_cast<uint8_t>(current_state.original_value));
+            break;
         case Page::DrumDebounceDelay:
             m_store->setDebounceDelay(current_state.original_value);
             break;
@@ -321,7 +404,7 @@ void Menu::gotoParent(bool do_restore) {
         } break;
         case Page::DrumDoubleTrigger:
             m_store->setDoubleTriggerMode(
-                static_cast<Peripherals::Drum::Config::DoubleTriggerMode>(current_state.original_value));
+                static_cast<Peripherals::DrumBase::Config::DoubleTriggerMode>(current_state.original_value));
             break;
         case Page::DrumDoubleTriggerThresholdKaLeft: {
             auto thresholds = m_store->getDoubleTriggerThresholds();
@@ -353,10 +436,14 @@ void Menu::gotoParent(bool do_restore) {
         case Page::LedEnablePlayerColor:
             m_store->setLedEnablePlayerColor(static_cast<bool>(current_state.original_value));
             break;
+        case Page::InputRemap:
+            m_store->setInputRemap(input_remap_presets[current_state.original_value]);
+            break;
         case Page::Main:
         case Page::Drum:
         case Page::DrumTriggerThresholds:
         case Page::DrumDoubleTriggerThresholds:
+        case Page::DrumSignalMeter:
         case Page::Led:
         case Page::Reset:
         case Page::Bootsel:
@@ -378,6 +465,9 @@ void Menu::performAction(Descriptor::Action action, uint16_t value) {
     case Descriptor::Action::GotoPageDeviceMode:
         gotoPage(Page::DeviceMode);
         break;
+    case Descriptor::Action::GotoPageProfile:
+        gotoPage(Page::Profile);
+        break;
     case Descriptor::Action::GotoPageDrum:
         gotoPage(Page::Drum);
         break;
@@ -388,12 +478,18 @@ void Menu::performAction(Descriptor::Action action, uint16_t value) {
         gotoPage(Page::DrumTriggerThresholds);
         break;
     case Descriptor::Action::GotoPageDrumDoubleTriggerThresholds:
-        m_store->setDoubleTriggerMode(Peripherals::Drum::Config::DoubleTriggerMode::Threshold);
+        m_store->setDoubleTriggerMode(Peripherals::DrumBase::Config::DoubleTriggerMode::Threshold);
         gotoPage(Page::DrumDoubleTriggerThresholds);
         break;
+    case Descriptor::Action::GotoPageDrumSignalMeter:
+        gotoPage(Page::DrumSignalMeter);
+        break;
     case Descriptor::Action::GotoPageLed:
         gotoPage(Page::Led);
         break;
+    case Descriptor::Action::GotoPageInputRemap:
+        gotoPage(Page::InputRemap);
+        break;
     case Descriptor::Action::GotoPageReset:
         gotoPage(Page::Reset);
         break;
@@ -436,15 +532,23 @@ void Menu::performAction(Descriptor::Action action, uint16_t value) {
     case Descriptor::Action::SetUsbMode:
         m_store->setUsbMode(static_cast<usb_mode_t>(value));
         break;
+    case Descriptor::Action::SetProfile:
+        m_store->setActiveProfile(static_cast<uint8_t>(value));
+        break;
+    case Descriptor::Action::SetInputRemap:
+        if (value < input_remap_presets.size()) {
+            m_store->setInputRemap(input_remap_presets[value]);
+        }
+        break;
     case Descriptor::Action::SetDrumDebounceDelay:
         m_store->setDebounceDelay(value);
         break;
     case Descriptor::Action::SetDoubleTriggerOff:
-        m_store->setDoubleTriggerMode(Peripherals::Drum::Config::DoubleTriggerMode::Off);
+        m_store->setDoubleTriggerMode(Peripherals::DrumBase::Config::DoubleTriggerMode::Off);
         gotoParent(false);
         break;
     case Descriptor::Action::SetDoubleTriggerAlways:
-        m_store->setDoubleTriggerMode(Peripherals::Drum::Config::DoubleTriggerMode::Always);
+        m_store->setDoubleTriggerMode(Peripherals::DrumBase::Config::DoubleTriggerMode::Always);
         gotoParent(false);
         break;
     case Descriptor::Action::SetDrumTriggerThresholdKaLeft: {
@@ -516,32 +620,30 @@ void Menu::update(const InputState::Controller &controller_state) {
 
     State &current_state = m_state_stack.top();
 
-    auto descriptor_it = descriptors.find(current_state.page);
-    if (descriptor_it == descriptors.end()) {
-        assert(false);
-        return;
-    }
+    const auto &descriptor = getDescriptor(current_state.page);
 
-    if (descriptor_it->second.type == Descriptor::Type::RebootInfo) {
+    current_state.selected_value = clamp_selection(descriptor, current_state.selected_value);
+
+    if (descriptor.type == Descriptor::Type::RebootInfo) {
         m_active = false;
     } else if (m_buttons.getPressed(Buttons::Id::Left)) {
-        switch (descriptor_it->second.type) {
+        switch (descriptor.type) {
         case Descriptor::Type::Toggle:
             current_state.selected_value = current_state.selected_value == 0 ? 1 : 0;
-            performAction(descriptor_it->second.items.at(0).second, current_state.selected_value);
+            performAction(descriptor.items[0].action, current_state.selected_value);
             break;
         case Descriptor::Type::Selection:
             if (current_state.selected_value == 0) {
-                current_state.selected_value = descriptor_it->second.items.size() - 1;
+                current_state.selected_value = descriptor.items.size() - 1;
             } else {
                 current_state.selected_value--;
             }
-            performAction(descriptor_it->second.items.at(current_state.selected_value).second,
-                          current_state.selected_value);
+            performAction(descriptor.items[current_state.selected_value].action, current_state.selected_value);
             break;
         case Descriptor::Type::Menu:
+        case Descriptor::Type::Meter:
             if (current_state.selected_value == 0) {
-                current_state.selected_value = descriptor_it->second.items.size() - 1;
+                current_state.selected_value = descriptor.items.size() - 1;
             } else {
                 current_state.selected_value--;
             }
@@ -551,22 +653,22 @@ void Menu::update(const InputState::Controller &controller_state) {
             break;
         }
     } else if (m_buttons.getPressed(Buttons::Id::Right)) {
-        switch (descriptor_it->second.type) {
+        switch (descriptor.type) {
         case Descriptor::Type::Toggle:
             current_state.selected_value = current_state.selected_value == 0 ? 1 : 0;
-            performAction(descriptor_it->second.items.at(0).second, current_state.selected_value);
+            performAction(descriptor.items[0].action, current_state.selected_value);
             break;
         case Descriptor::Type::Selection:
-            if (current_state.selected_value == descriptor_it->second.items.size() - 1) {
+            if (current_state.selected_value == descriptor.items.size() - 1) {
                 current_state.selected_value = 0;
             } else {
                 current_state.selected_value++;
             }
-            performAction(descriptor_it->second.items.at(current_state.selected_value).second,
-                          current_state.selected_value);
+            performAction(descriptor.items[current_state.selected_value].action, current_state.selected_value);
             break;
         case Descriptor::Type::Menu:
-            if (current_state.selected_value == descriptor_it->second.items.size() - 1) {
+        case Descriptor::Type::Meter:
+            if (current_state.selected_value == descriptor.items.size() - 1) {
                 current_state.selected_value = 0;
             } else {
                 current_state.selected_value++;
@@ -577,13 +679,16 @@ void Menu::update(const InputState::Controller &controller_state) {
             break;
         }
     } else if (m_buttons.getPressed(Buttons::Id::Up)) {
-        switch (descriptor_it->second.type) {
+        switch (descriptor.type) {
         case Descriptor::Type::Value:
-            if (current_state.selected_value < descriptor_it->second.max_value) {
+            if (current_state.selected_value < descriptor.max_value) {
                 current_state.selected_value++;
-                performAction(descriptor_it->second.items.at(0).second, current_state.selected_value);
+                performAction(descriptor.items[0].action, current_state.selected_value);
             }
             break;
+        case Descriptor::Type::Meter:
+            stepMeterThreshold(current_state.selected_value, m_buttons.getStep(Buttons::Id::Up));
+            break;
         case Descriptor::Type::Toggle:
         case Descriptor::Type::Selection:
         case Descriptor::Type::Menu:
@@ -591,13 +696,16 @@ void Menu::update(const InputState::Controller &controller_state) {
             break;
         }
     } else if (m_buttons.getPressed(Buttons::Id::Down)) {
-        switch (descriptor_it->second.type) {
+        switch (descriptor.type) {
         case Descriptor::Type::Value:
             if (current_state.selected_value > 0) {
                 current_state.selected_value--;
-                performAction(descriptor_it->second.items.at(0).second, current_state.selected_value);
+                performAction(descriptor.items[0].action, current_state.selected_value);
             }
             break;
+        case Descriptor::Type::Meter:
+            stepMeterThreshold(current_state.selected_value, -m_buttons.getStep(Buttons::Id::Down));
+            break;
         case Descriptor::Type::Toggle:
         case Descriptor::Type::Selection:
         case Descriptor::Type::Menu:
@@ -605,28 +713,29 @@ void Menu::update(const InputState::Controller &controller_state) {
             break;
         }
     } else if (m_buttons.getPressed(Buttons::Id::Back)) {
-        switch (descriptor_it->second.type) {
+        switch (descriptor.type) {
         case Descriptor::Type::Value:
         case Descriptor::Type::Toggle:
         case Descriptor::Type::Selection:
             gotoParent(true);
             break;
         case Descriptor::Type::Menu:
+        case Descriptor::Type::Meter: // Threshold changes are applied immediately and kept
             gotoParent(false);
             break;
         case Descriptor::Type::RebootInfo:
             break;
         }
     } else if (m_buttons.getPressed(Buttons::Id::Confirm)) {
-        switch (descriptor_it->second.type) {
+        switch (descriptor.type) {
         case Descriptor::Type::Value:
         case Descriptor::Type::Toggle:
         case Descriptor::Type::Selection:
+        case Descriptor::Type::Meter:
             gotoParent(false);
             break;
         case Descriptor::Type::Menu:
-            performAction(descriptor_it->second.items.at(current_state.selected_value).second,
-                          current_state.selected_value);
+            performAction(descriptor.items[current_state.selected_value].action, current_state.selected_value);
             break;
         case Descriptor::Type::RebootInfo:
             break;
@@ -634,6 +743,22 @@ void Menu::update(const InputState::Controller &controller_state) {
     }
 }
 
+void Menu::stepMeterThreshold(const uint16_t pad, const int32_t step) {
+    static const std::array<Page, 4> threshold_pages = {
+        Page::DrumTriggerThresholdKaLeft, Page::DrumTriggerThresholdDonLeft, Page::DrumTriggerThresholdDonRight,
+        Page::DrumTriggerThresholdKaRight};
+
+    if (pad >= threshold_pages.size()) {
+        return;
+    }
+
+    const int32_t current_value = getCurrentValue(threshold_pages[pad]);
+    const int32_t value = std::clamp<int32_t>(current_value + step, 0, getDescriptor(Page::DrumSignalMeter).max_value);
+    if (value != current_value) {
+        performAction(getDescriptor(Page::DrumSignalMeter).items[pad].action, static_cast<uint16_t>(value));
+    }
+}
+
 bool Menu::active() const { return m_active; }
 
 Menu::State Menu::getState() const { return m_state_stack.top(); }
@@ -2,99 +2,400 @@
 
 #include "GlobalConfiguration.h"
 
+#include "hardware/structs/nvic.h"
 #include "hardware/watchdog.h"
 #include "pico/bootrom.h"
 #include "pico/multicore.h"
+#include "pico/time.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
 
 namespace Doncon::Utils {
 
 namespace {
 
-uint8_t read_byte(uint32_t offset) {
-    return *(reinterpret_cast<uint8_t *>(XIP_BASE + offset)); // NOLINT(performance-no-int-to-ptr)
+const uint8_t *flash_ptr(uint32_t offset) {
+    return reinterpret_cast<const uint8_t *>(XIP_BASE + offset); // NOLINT(performance-no-int-to-ptr)
+}
+
+constexpr auto crc16_lut = [] {
+    std::array<uint16_t, 256> lut{};
+    for (size_t i = 0; i < lut.size(); ++i) {
+        auto crc = static_cast<uint16_t>(i << 8);
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+        lut[i] = crc;
+    }
+    return lut;
+}();
+
+uint16_t crc16(const uint8_t *data, const size_t length, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < length; ++i) {
+        crc = static_cast<uint16_t>((crc << 8) ^ crc16_lut[((crc >> 8) ^ data[i]) & 0xFF]);
+    }
+    return crc;
 }
 
+// Page layout used before the journal, kept to migrate existing settings.
+struct __attribute((packed, aligned(1))) LegacyStorecache {
+    uint8_t in_use;
+    usb_mode_t usb_mode;
+    Peripherals::DrumBase::Config::Thresholds trigger_thresholds;
+    uint8_t led_brightness;
+    bool led_enable_player_color;
+    uint16_t debounce_delay;
+    Peripherals::DrumBase::Config::DoubleTriggerMode double_trigger_mode;
+    Peripherals::DrumBase::Config::Thresholds double_trigger_thresholds;
+    InputRemap::Mapping input_remap;
+};
+const uint32_t legacy_flash_size = 2 * FLASH_SECTOR_SIZE;
+const uint8_t legacy_magic_byte = 0x39;
+
 } // namespace
 
-SettingsStore::SettingsStore()
-    : m_store_cache({.in_use = m_magic_byte,
-                     .usb_mode = Config::Default::usb_mode,
-                     .trigger_thresholds = Config::Default::drum_config.trigger_thresholds,
-                     .led_brightness = Config::Default::led_config.brightness,
-                     .led_enable_player_color = Config::Default::led_config.enable_player_color,
-                     .debounce_delay = Config::Default::drum_config.debounce_delay_ms,
-                     .double_trigger_mode = Config::Default::drum_config.double_trigger_mode,
-                     .double_trigger_thresholds = Config::Default::drum_config.double_trigger_thresholds,
-                     ._padding = {}}) {
-    uint32_t current_page = m_flash_offset + m_flash_size - m_store_size;
-    bool found_valid = false;
-    for (size_t i = 0; i < m_store_pages; ++i) {
-        if (read_byte(current_page) == m_magic_byte) {
-            found_valid = true;
+static_assert(Config::Default::profile_names.size() == SettingsStore::PROFILE_COUNT);
+
+SettingsStore::SettingsStore() : m_store_cache(getDefaults()) {
+    const uint32_t start = time_us_32();
+
+    // The active sector is the valid one with the latest sequence number.
+    for (uint32_t sector = 0; sector < m_sector_count; ++sector) {
+        SectorHeader header;
+        std::memcpy(&header, flash_ptr(getSectorOffset(sector)), sizeof(header));
+
+        if (header.magic == m_sector_magic &&
+            (!m_active_sector || static_cast<int32_t>(header.sequence - m_sequence) > 0)) {
+            m_active_sector = sector;
+            m_sequence = header.sequence;
+        }
+    }
+
+    if (m_active_sector) {
+        load(*m_active_sector);
+    } else if (loadLegacy()) {
+        m_needs_compaction = true;
+    }
+
+    // Checking the other sectors reads them completely, this is left to update() to keep booting fast.
+    m_load_time_us = time_us_32() - start;
+}
+
+SettingsStore::Storecache SettingsStore::getDefaults() {
+    Storecache defaults = {.usb_mode = Config::Default::usb_mode,
+                           .led_brightness = Config::Default::led_config.brightness,
+                           .led_enable_player_color = Config::Default::led_config.enable_player_color,
+                           .input_remap = Config::Default::input_remap,
+                           .active_profile = 0,
+                           .profiles = {}};
+
+    defaults.profiles.fill({
+        .trigger_thresholds = Config::Default::drum_config.trigger_thresholds,
+        .debounce_delay = Config::Default::drum_config.debounce_delay_ms,
+        .double_trigger_mode = Config::Default::drum_config.double_trigger_mode,
+        .double_trigger_thresholds = Config::Default::drum_config.double_trigger_thresholds,
+    });
+
+    return defaults;
+}
+
+void SettingsStore::markDirty(const Key key) {
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+        if (m_fields[i].key == key) {
+            m_dirty_fields |= (1U << i);
+        }
+    }
+}
+
+void SettingsStore::markProfileDirty(const Key key) { markDirty(getProfileKey(key, m_store_cache.active_profile)); }
+
+SettingsStore::Profile &SettingsStore::activeProfile() { return m_store_cache.profiles[m_store_cache.active_profile]; }
+const SettingsStore::Profile &SettingsStore::activeProfile() const {
+    return m_store_cache.profiles[m_store_cache.active_profile];
+}
+
+void SettingsStore::load(const uint32_t sector) {
+    const uint32_t sector_offset = getSectorOffset(sector);
+    uint32_t offset = sizeof(SectorHeader);
+
+    while (offset + sizeof(RecordHeader) <= FLASH_SECTOR_SIZE) {
+        RecordHeader header;
+        std::memcpy(&header, flash_ptr(sector_offset + offset), sizeof(header));
+
+        const auto *header_bytes = reinterpret_cast<const uint8_t *>(&header);
+        if (std::all_of(header_bytes, header_bytes + sizeof(header), [](const uint8_t byte) { return byte == 0xFF; })) {
+            break; // End of journal
+        }
+
+        const uint8_t *value = flash_ptr(sector_offset + offset + sizeof(header));
+        const bool fits = offset + sizeof(header) + header.length <= FLASH_SECTOR_SIZE;
+        if (!fits || crc16(value, header.length, crc16(header_bytes, offsetof(RecordHeader, crc))) != header.crc) {
+            // Most likely an interrupted write, records past this point can't be trusted.
+            m_needs_compaction = true;
             break;
         }
-        current_page -= m_store_size;
+
+        applyRecord(header, value);
+        offset += sizeof(header) + header.length;
+    }
+
+    m_write_offset = offset;
+    m_dirty_fields = 0;
+
+    if (m_store_cache.active_profile >= PROFILE_COUNT) {
+        m_store_cache.active_profile = 0;
+    }
+}
+
+bool SettingsStore::loadLegacy() {
+    const uint32_t legacy_offset = PICO_FLASH_SIZE_BYTES - legacy_flash_size;
+
+    for (uint32_t page = legacy_offset + legacy_flash_size - FLASH_PAGE_SIZE; page >= legacy_offset;
+         page -= FLASH_PAGE_SIZE) {
+        if (*flash_ptr(page) == legacy_magic_byte) {
+            LegacyStorecache legacy;
+            std::memcpy(&legacy, flash_ptr(page), sizeof(legacy));
+
+            m_store_cache.usb_mode = legacy.usb_mode;
+            m_store_cache.led_brightness = legacy.led_brightness;
+            m_store_cache.led_enable_player_color = legacy.led_enable_player_color;
+            m_store_cache.input_remap = legacy.input_remap;
+            m_store_cache.profiles[0] = {.trigger_thresholds = legacy.trigger_thresholds,
+                                         .debounce_delay = legacy.debounce_delay,
+                                         .double_trigger_mode = legacy.double_trigger_mode,
+                                         .double_trigger_thresholds = legacy.double_trigger_thresholds};
+            return true;
+        }
+    }
+    return false;
+}
+
+void SettingsStore::applyRecord(const RecordHeader &header, const uint8_t *value) {
+    for (const auto &field : m_fields) {
+        // Records of unknown keys or versions are ignored, the default value stays in place.
+        if (field.key == header.key && field.version == header.version && field.size == header.length) {
+            std::memcpy(reinterpret_cast<uint8_t *>(&m_store_cache) + field.offset, value, field.size);
+            return;
+        }
+    }
+}
+
+size_t SettingsStore::serialize(const uint32_t fields, std::span<uint8_t> buffer) const {
+    static_assert(
+        [] {
+            size_t size = 0;
+            for (const auto &field : m_fields) {
+                size += sizeof(RecordHeader) + field.size;
+            }
+            return size;
+        }() <= FLASH_PAGE_SIZE,
+        "All records must fit into a single page buffer");
+
+    size_t length = 0;
+
+    for (size_t i = 0; i < m_fields.size(); ++i) {
+        if ((fields & (1U << i)) == 0) {
+            continue;
+        }
+
+        const auto &field = m_fields[i];
+        const auto *value = reinterpret_cast<const uint8_t *>(&m_store_cache) + field.offset;
+
+        RecordHeader header = {
+            .key = field.key, .version = field.version, .length = static_cast<uint8_t>(field.size), .crc = 0};
+        header.crc = crc16(value, field.size,
+                           crc16(reinterpret_cast<const uint8_t *>(&header), offsetof(RecordHeader, crc)));
+
+        std::memcpy(&buffer[length], &header, sizeof(header));
+        std::memcpy(&buffer[length + sizeof(header)], value, field.size);
+        length += sizeof(header) + field.size;
+    }
+
+    return length;
+}
+
+uint32_t SettingsStore::getSectorOffset(const uint32_t sector) { return m_flash_offset + sector * FLASH_SECTOR_SIZE; }
+
+bool SettingsStore::isErased(const uint32_t offset, const size_t length) {
+    const uint8_t *begin = flash_ptr(offset);
+    return std::all_of(begin, begin + length, [](const uint8_t byte) { return byte == 0xFF; });
+}
+
+// Checks the whole sector, it might be partially erased after a power loss or contain stray data.
+bool SettingsStore::isSectorErased(const uint32_t sector) {
+    return isErased(getSectorOffset(sector), FLASH_SECTOR_SIZE);
+}
+
+void SettingsStore::updateErasePending() {
+    m_erase_pending = 0;
+    m_erase_check_pending = false;
+
+    // Nothing has been written yet, keep everything since it might still contain legacy settings.
+    if (!m_active_sector) {
+        return;
+    }
+
+    for (uint32_t sector = 0; sector < m_sector_count; ++sector) {
+        if (sector != m_active_sector && !isSectorErased(sector)) {
+            m_erase_pending |= (1U << sector);
+        }
     }
+}
+
+// Runs a flash operation with core 1 paused. XIP is unavailable in the meantime, so only interrupts
+// with handlers in SRAM stay enabled. This keeps drum sampling alive, other interrupts are delayed.
+// This includes USB, the TinyUSB interrupt handler runs from flash. The USB controller keeps NAKing
+// on its own, so the connection stays up and only reports are delayed.
+template <typename TOperation> void SettingsStore::runFlashOperation(TimingStats &timing, TOperation operation) {
+    const uint32_t start = time_us_32();
+
+    multicore_lockout_start_blocking();
+    const uint32_t masked_irqs = nvic_hw->iser & ~Config::Default::DrumAdc::getRamIrqMask();
+    nvic_hw->icer = masked_irqs;
+
+    operation();
+
+    nvic_hw->iser = masked_irqs;
+    multicore_lockout_end_blocking();
+
+    timing.record(time_us_32() - start);
+}
+
+// Programs arbitrary ranges by padding them to full pages with 0xFF, which leaves already programmed bytes as is.
+void SettingsStore::program(const uint32_t offset, std::span<const uint8_t> data) {
+    std::array<uint8_t, FLASH_PAGE_SIZE> page_buffer{};
+
+    uint32_t position = offset;
+    while (!data.empty()) {
+        const uint32_t page = position - (position % FLASH_PAGE_SIZE);
+        const size_t count = std::min<size_t>(data.size(), page + FLASH_PAGE_SIZE - position);
 
-    if (found_valid) {
-        m_store_cache = *(reinterpret_cast<Storecache *>(XIP_BASE + current_page)); // NOLINT(performance-no-int-to-ptr)
-        m_dirty = false;
+        page_buffer.fill(0xFF);
+        std::memcpy(&page_buffer[position - page], data.data(), count);
+        runFlashOperation(m_program_timing,
+                          [&]() { flash_range_program(page, page_buffer.data(), page_buffer.size()); });
+
+        position += count;
+        data = data.subspan(count);
     }
 }
 
+void SettingsStore::erase(const uint32_t sector) {
+    runFlashOperation(m_erase_timing, [sector]() { flash_range_erase(getSectorOffset(sector), FLASH_SECTOR_SIZE); });
+    m_erase_pending &= ~(1U << sector);
+}
+
+// Sector the journal moves on to with the next compaction.
+uint32_t SettingsStore::getNextSector() const { return m_active_sector ? (*m_active_sector + 1) % m_sector_count : 0; }
+
+// Whether append() would have to compact into a sector which is not erased yet.
+bool SettingsStore::appendNeedsErase() const {
+    std::array<uint8_t, FLASH_PAGE_SIZE> buffer{};
+    const size_t length = serialize(m_dirty_fields, buffer);
+
+    const bool fits = m_active_sector && !m_needs_compaction && m_write_offset + length <= FLASH_SECTOR_SIZE &&
+                      isErased(getSectorOffset(*m_active_sector) + m_write_offset, length);
+
+    return !fits && !isSectorErased(getNextSector());
+}
+
+// Appends records for all changed values to the active sector.
+void SettingsStore::append() {
+    std::array<uint8_t, FLASH_PAGE_SIZE> buffer{};
+    const size_t length = serialize(m_dirty_fields, buffer);
+
+    // Programming over anything but 0xFF would corrupt the new records, move on to a fresh sector in this case.
+    if (!m_active_sector || m_needs_compaction || m_write_offset + length > FLASH_SECTOR_SIZE ||
+        !isErased(getSectorOffset(*m_active_sector) + m_write_offset, length)) {
+        compact();
+        return;
+    }
+
+    program(getSectorOffset(*m_active_sector) + m_write_offset, {buffer.data(), length});
+
+    m_write_offset += length;
+    m_dirty_fields = 0;
+}
+
+// Writes all current values to the next sector. The sector header is programmed last, so an interrupted
+// compaction leaves the previous sector active.
+void SettingsStore::compact() {
+    const uint32_t sector = getNextSector();
+    if (!isSectorErased(sector)) {
+        // Was not erased ahead of time, need to do it now.
+        erase(sector);
+    }
+
+    std::array<uint8_t, FLASH_PAGE_SIZE> buffer{};
+    const size_t length = serialize(m_all_fields, buffer);
+    program(getSectorOffset(sector) + sizeof(SectorHeader), {buffer.data(), length});
+
+    const SectorHeader header = {.magic = m_sector_magic, .sequence = m_sequence + 1};
+    program(getSectorOffset(sector), {reinterpret_cast<const uint8_t *>(&header), sizeof(header)});
+
+    m_active_sector = sector;
+    m_sequence = header.sequence;
+    m_write_offset = sizeof(SectorHeader) + length;
+    m_needs_compaction = false;
+    m_dirty_fields = 0;
+
+    // The previously active sector is stale now.
+    m_erase_check_pending = true;
+}
+
 void SettingsStore::setUsbMode(const usb_mode_t mode) {
     if (mode != m_store_cache.usb_mode) {
         m_store_cache.usb_mode = mode;
-        m_dirty = true;
-
-        scheduleReboot();
+        markDirty(Key::UsbMode);
     }
 }
 
 usb_mode_t SettingsStore::getUsbMode() const { return m_store_cache.usb_mode; }
 
-void SettingsStore::setTriggerThresholds(const Peripherals::Drum::Config::Thresholds &thresholds) {
-    if (m_store_cache.trigger_thresholds.don_left != thresholds.don_left ||
-        m_store_cache.trigger_thresholds.don_right != thresholds.don_right ||
-        m_store_cache.trigger_thresholds.ka_left != thresholds.ka_left ||
-        m_store_cache.trigger_thresholds.ka_right != thresholds.ka_right) {
+void SettingsStore::setTriggerThresholds(const Peripherals::DrumBase::Config::Thresholds &thresholds) {
+    if (activeProfile().trigger_thresholds.don_left != thresholds.don_left ||
+        activeProfile().trigger_thresholds.don_right != thresholds.don_right ||
+        activeProfile().trigger_thresholds.ka_left != thresholds.ka_left ||
+        activeProfile().trigger_thresholds.ka_right != thresholds.ka_right) {
 
-        m_store_cache.trigger_thresholds = thresholds;
-        m_dirty = true;
+        activeProfile().trigger_thresholds = thresholds;
+        markProfileDirty(Key::TriggerThresholds);
     }
 }
-Peripherals::Drum::Config::Thresholds SettingsStore::getTriggerThresholds() const {
-    return m_store_cache.trigger_thresholds;
+Peripherals::DrumBase::Config::Thresholds SettingsStore::getTriggerThresholds() const {
+    return activeProfile().trigger_thresholds;
 }
 
-void SettingsStore::setDoubleTriggerMode(const Peripherals::Drum::Config::DoubleTriggerMode &mode) {
-    if (m_store_cache.double_trigger_mode != mode) {
-        m_store_cache.double_trigger_mode = mode;
-        m_dirty = true;
+void SettingsStore::setDoubleTriggerMode(const Peripherals::DrumBase::Config::DoubleTriggerMode &mode) {
+    if (activeProfile().double_trigger_mode != mode) {
+        activeProfile().double_trigger_mode = mode;
+        markProfileDirty(Key::DoubleTriggerMode);
     }
 }
-Peripherals::Drum::Config::DoubleTriggerMode SettingsStore::getDoubleTriggerMode() const {
-    return m_store_cache.double_trigger_mode;
+Peripherals::DrumBase::Config::DoubleTriggerMode SettingsStore::getDoubleTriggerMode() const {
+    return activeProfile().double_trigger_mode;
 }
 
-void SettingsStore::setDoubleTriggerThresholds(const Peripherals::Drum::Config::Thresholds &thresholds) {
-    if (m_store_cache.double_trigger_thresholds.don_left != thresholds.don_left ||
-        m_store_cache.double_trigger_thresholds.don_right != thresholds.don_right ||
-        m_store_cache.double_trigger_thresholds.ka_left != thresholds.ka_left ||
-        m_store_cache.double_trigger_thresholds.ka_right != thresholds.ka_right) {
+void SettingsStore::setDoubleTriggerThresholds(const Peripherals::DrumBase::Config::Thresholds &thresholds) {
+    if (activeProfile().double_trigger_thresholds.don_left != thresholds.don_left ||
+        activeProfile().double_trigger_thresholds.don_right != thresholds.don_right ||
+        activeProfile().double_trigger_thresholds.ka_left != thresholds.ka_left ||
+        activeProfile().double_trigger_thresholds.ka_right != thresholds.ka_right) {
 
-        m_store_cache.double_trigger_thresholds = thresholds;
-        m_dirty = true;
+        activeProfile().double_trigger_thresholds = thresholds;
+        markProfileDirty(Key::DoubleTriggerThresholds);
     }
 }
-Peripherals::Drum::Config::Thresholds SettingsStore::getDoubleTriggerThresholds() const {
-    return m_store_cache.double_trigger_thresholds;
+Peripherals::DrumBase::Config::Thresholds SettingsStore::getDoubleTriggerThresholds() const {
+    return activeProfile().double_trigger_thresholds;
 }
 
 void SettingsStore::setLedBrightness(const uint8_t brightness) {
     if (m_store_cache.led_brightness != brightness) {
         m_store_cache.led_brightness = brightness;
-        m_dirty = true;
+        markDirty(Key::LedBrightness);
     }
 }
 uint8_t SettingsStore::getLedBrightness() const { return m_store_cache.led_brightness; }
@@ -102,45 +403,49 @@ uint8_t SettingsStore::getLedBrightness() const { return m_store_cache.led_brigh
 void SettingsStore::setLedEnablePlayerColor(const bool do_enable) {
     if (m_store_cache.led_enable_player_color != do_enable) {
         m_store_cache.led_enable_player_color = do_enable;
-        m_dirty = true;
+        markDirty(Key::LedEnablePlayerColor);
     }
 }
 bool SettingsStore::getLedEnablePlayerColor() const { return m_store_cache.led_enable_player_color; }
 
 void SettingsStore::setDebounceDelay(const uint16_t delay) {
-    if (m_store_cache.debounce_delay != delay) {
-        m_store_cache.debounce_delay = delay;
-        m_dirty = true;
+    if (activeProfile().debounce_delay != delay) {
+        activeProfile().debounce_delay = delay;
+        markProfileDirty(Key::DebounceDelay);
     }
 }
-uint16_t SettingsStore::getDebounceDelay() const { return m_store_cache.debounce_delay; }
+uint16_t SettingsStore::getDebounceDelay() const { return activeProfile().debounce_delay; }
 
-void SettingsStore::store() {
-    if (m_dirty) {
-        multicore_lockout_start_blocking();
-        const uint32_t interrupts = save_and_disable_interrupts();
-
-        uint32_t current_page = m_flash_offset;
-        bool do_erase = true;
-        for (size_t i = 0; i < m_store_pages; ++i) {
-            if (read_byte(current_page) == 0xFF) {
-                do_erase = false;
-                break;
-            }
-            current_page += m_store_size;
-        }
-
-        if (do_erase) {
-            flash_range_erase(m_flash_offset, m_flash_size);
-            current_page = m_flash_offset;
-        }
+void SettingsStore::setInputRemap(const InputRemap::Mapping &mapping) {
+    if (m_store_cache.input_remap != mapping) {
+        m_store_cache.input_remap = mapping;
+        markDirty(Key::InputRemap);
+    }
+}
+InputRemap::Mapping SettingsStore::getInputRemap() const {
+    // Settings stored by older firmware versions contain zeroes here, fall back to the default in this case.
+    if (!InputRemap::isValid(m_store_cache.input_remap)) {
+        return Config::Default::input_remap;
+    }
+    return m_store_cache.input_remap;
+}
 
-        flash_range_program(current_page, reinterpret_cast<uint8_t *>(&m_store_cache), sizeof(m_store_cache));
+void SettingsStore::setActiveProfile(const uint8_t profile) {
+    if (profile < PROFILE_COUNT && m_store_cache.active_profile != profile) {
+        m_store_cache.active_profile = profile;
+        markDirty(Key::ActiveProfile);
+    }
+}
+uint8_t SettingsStore::getActiveProfile() const { return m_store_cache.active_profile; }
 
-        m_dirty = false;
+void SettingsStore::store() {
+    if (m_dirty_fields != 0 || m_needs_compaction) {
+        append();
+    }
 
-        restore_interrupts_from_disabled(interrupts);
-        multicore_lockout_end_blocking();
+    // Nothing to prepare if the journal has not been started yet, it might still hold legacy settings.
+    if (m_active_sector && m_scheduled_reboot == RebootType::None && !isSectorErased(getNextSector())) {
+        erase(getNextSector());
     }
 
     switch (m_scheduled_reboot) {
@@ -156,19 +461,37 @@ void SettingsStore::store() {
     }
 }
 
+// Writes the defaults as a new snapshot instead of erasing the whole journal at once. This only needs to erase
+// the next sector if it wasn't erased already, all other sectors become stale and are erased later.
 void SettingsStore::reset() {
-    multicore_lockout_start_blocking();
-    const uint32_t interrupts = save_and_disable_interrupts();
+    m_store_cache = getDefaults();
+    m_needs_compaction = true;
 
-    flash_range_erase(m_flash_offset, m_flash_size);
+    scheduleReboot();
+    store();
+}
 
-    restore_interrupts(interrupts);
-    multicore_lockout_end_blocking();
+void SettingsStore::update(const bool input_active, const bool host_active) {
+    const uint32_t now = to_ms_since_boot(get_absolute_time());
 
-    m_dirty = false;
+    if (input_active) {
+        m_last_activity = now;
+        return;
+    }
+    if ((now - m_last_activity) <= m_idle_delay_ms) {
+        return;
+    }
 
-    scheduleReboot();
-    store();
+    // A pause in the input does not mean the host stopped polling, e.g. in the middle of a song. Page programs
+    // delay a report by a few milliseconds at most, erases only happen when the host can't notice. One flash
+    // operation at a time to keep the stall short.
+    if (m_dirty_fields != 0 && (!host_active || !appendNeedsErase())) {
+        append();
+    } else if (m_erase_check_pending) {
+        updateErasePending();
+    } else if (m_erase_pending != 0 && !host_active) {
+        erase(static_cast<uint32_t>(std::countr_zero(m_erase_pending)));
+    }
 }
 
 void SettingsStore::scheduleReboot(const bool bootsel) {